@@ -0,0 +1,56 @@
+/**
+ * @file arena.cc
+ * @brief bump pointer arena for tree nodes
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <stdlib.h>
+#include <new>
+#include "arena.h"
+
+YxlangArena::~YxlangArena() {
+    for (unsigned int i = 0; i < chunks.size(); ++i) {
+        free(chunks[i].begin);
+    }
+}
+
+void YxlangArena::grow(size_t size) {
+    /* double the chunk size each time, so a large parse needs few chunks */
+    size_t n = chunks.empty() ? chunksize : chunks.back().size * 2;
+    while (n < size)
+        n *= 2;
+    Chunk chunk;
+    /* malloc aligns for any fundamental type, at least ALIGN on x86-64 */
+    chunk.begin = static_cast<char*>(malloc(n));
+    if (!chunk.begin)
+        throw std::bad_alloc();
+    chunk.size = n;
+    chunks.push_back(chunk);
+    top = chunk.begin;
+    end = chunk.begin + n;
+}
+
+void YxlangArena::release() {
+    for (unsigned int i = 1; i < chunks.size(); ++i) {
+        free(chunks[i].begin);
+    }
+    if (chunks.size() > 1)
+        chunks.resize(1);
+    if (chunks.empty()) {
+        top = end = NULL;
+    } else {
+        top = chunks[0].begin;
+        end = top + chunks[0].size;
+    }
+    pinned = false;
+}
+
+bool YxlangArena::contains(const void* p) const {
+    const char* c = static_cast<const char*>(p);
+    for (unsigned int i = 0; i < chunks.size(); ++i) {
+        if (c >= chunks[i].begin && c < chunks[i].begin + chunks[i].size)
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file arena.h
+ * @brief bump pointer arena for tree nodes
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <vector>
+
+/** Hands out memory by bumping a pointer through chunks that grow
+ * geometrically. Nothing is freed one by one, release() gives back all of
+ * it at once, keeping the first chunk for the next parse. Destructors of
+ * the objects in it are not run. */
+class YxlangArena {
+public:
+    explicit YxlangArena(size_t _chunksize = 4096) : chunksize(_chunksize), top(NULL), end(NULL), pinned(false), holders(0) {
+    }
+
+    ~YxlangArena();
+
+    void*	allocate(size_t size) {
+        size = (size + ALIGN - 1) & ~(ALIGN - 1);
+        if (static_cast<size_t>(end - top) < size)
+            grow(size);
+        void* p = top;
+        top += size;
+        return p;
+    }
+
+    /** drop everything allocated so far */
+    void	release();
+    /** true if p was allocated from this arena */
+    bool	contains(const void* p) const;
+
+    /** mark the arena as referenced from outside its expressions, such as
+     * by a function definition, so it has to outlive them */
+    void	pin() {
+        pinned = true;
+    }
+    bool	isPinned() const {
+        return pinned;
+    }
+
+    /** count something outside the arena that needs it to stay, such as
+     * a current function definition living in it */
+    void	hold() {
+        ++holders;
+    }
+    /** undo one hold(), returns true once nothing holds the arena */
+    bool	drop() {
+        return --holders == 0;
+    }
+    bool	isHeld() const {
+        return holders != 0;
+    }
+
+private:
+    enum { ALIGN = 16 };
+
+    YxlangArena(const YxlangArena &);
+    YxlangArena& operator=(const YxlangArena &);
+
+    void	grow(size_t size);
+
+    struct Chunk {
+        char*	begin;
+        size_t	size;
+    };
+    std::vector<Chunk>	chunks;
+    size_t	chunksize;
+    char*	top;
+    char*	end;
+    bool	pinned;
+    size_t	holders;
+};
+
+#endif // ARENA_H
@@ -0,0 +1,573 @@
+/**
+ * @file batch.cc
+ * @brief vector-at-a-time evaluation of one expression over many rows
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <string.h>
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+#include "batch.h"
+#include "vecmath.h"
+
+namespace {
+
+struct OpAdd { static double apply(double a, double b) { return a + b; } };
+struct OpSubtract { static double apply(double a, double b) { return a - b; } };
+struct OpMultiply { static double apply(double a, double b) { return a * b; } };
+struct OpDivide { static double apply(double a, double b) { return a / b; } };
+struct OpModulo { static double apply(double a, double b) { return std::fmod(a, b); } };
+struct OpGT { static double apply(double a, double b) { return a > b ? 1 : 0; } };
+struct OpLT { static double apply(double a, double b) { return a < b ? 1 : 0; } };
+struct OpNE { static double apply(double a, double b) { return a != b ? 1 : 0; } };
+struct OpEQ { static double apply(double a, double b) { return a == b ? 1 : 0; } };
+struct OpGE { static double apply(double a, double b) { return a >= b ? 1 : 0; } };
+struct OpLE { static double apply(double a, double b) { return a <= b ? 1 : 0; } };
+struct OpMove { static double apply(double a) { return a; } };
+struct OpNegate { static double apply(double a) { return - a; } };
+
+/* a dense loop when every row is selected, so the compiler can vectorize
+ * it, otherwise one pass over the selection vector */
+template <class Op>
+void unary(double* d, const double* a, const uint32_t* sel, unsigned int n) {
+    if (!sel) {
+        for (unsigned int r = 0; r < n; ++r)
+            d[r] = Op::apply(a[r]);
+    } else {
+        for (unsigned int k = 0; k < n; ++k) {
+            uint32_t r = sel[k];
+            d[r] = Op::apply(a[r]);
+        }
+    }
+}
+
+template <class Op>
+void binary(double* d, const double* a, const double* b, const uint32_t* sel, unsigned int n) {
+    if (!sel) {
+        for (unsigned int r = 0; r < n; ++r)
+            d[r] = Op::apply(a[r], b[r]);
+    } else {
+        for (unsigned int k = 0; k < n; ++k) {
+            uint32_t r = sel[k];
+            d[r] = Op::apply(a[r], b[r]);
+        }
+    }
+}
+
+/* the math kernels work on contiguous elements, selected rows are
+ * gathered into scratch columns and scattered back */
+void kernel(VecUnaryKernel f, double* d, const double* a, const uint32_t* sel, unsigned int n, double* scratch) {
+    if (!sel) {
+        f(d, a, n);
+        return;
+    }
+    for (unsigned int k = 0; k < n; ++k)
+        scratch[k] = a[sel[k]];
+    f(scratch, scratch, n);
+    for (unsigned int k = 0; k < n; ++k)
+        d[sel[k]] = scratch[k];
+}
+
+void kernel(VecBinaryKernel f, double* d, const double* a, const double* b, const uint32_t* sel, unsigned int n, double* scratch) {
+    if (!sel) {
+        f(d, a, b, n);
+        return;
+    }
+    double* scratchb = scratch + BatchProgram::BLOCK;
+    for (unsigned int k = 0; k < n; ++k) {
+        scratch[k] = a[sel[k]];
+        scratchb[k] = b[sel[k]];
+    }
+    f(scratch, scratch, scratchb, n);
+    for (unsigned int k = 0; k < n; ++k)
+        d[sel[k]] = scratch[k];
+}
+
+/** slots of the global variables node can assign, also in the bodies of
+ * the functions it defines */
+void assigned(const YxlangNode* node, std::set<unsigned int> &writes) {
+    if (!node)
+        return;
+    if (node->type() == NT_ASSIGNMENT)
+        writes.insert(static_cast<const CNAssignment*>(node)->slot);
+
+    YxlangNode::Children children(node);
+    unsigned int n = children.size();
+    for (unsigned int i = 0; i < n; ++i)
+        assigned(children[i], writes);
+}
+
+} // namespace
+
+BatchProgram* BatchCompiler::compile(const YxlangNode* node) {
+    BatchProgram* program = new BatchProgram();
+    BatchCompiler compiler(program);
+    compiler.constant(0);
+    compiler.prepare(node, 0);
+
+    /* constants come first, then variables, shares and temporaries */
+    uint32_t varbase = program->constants.size();
+    uint32_t sharebase = varbase + program->slots.size();
+    for (std::map<unsigned int, uint32_t>::iterator vi = compiler.variableindex.begin(); vi != compiler.variableindex.end(); ++vi)
+        vi->second += varbase;
+    for (std::map<const CNShare*, uint32_t>::iterator si = compiler.shares.begin(); si != compiler.shares.end(); ++si)
+        si->second += sharebase;
+    compiler.tempbase = sharebase + compiler.shares.size();
+
+    program->result = compiler.compileNode(node);
+    program->ncolumns = compiler.tempbase + compiler.maxtemps;
+    for (unsigned int i = 0; i < program->code.size(); ++i) {
+        uint8_t op = program->code[i].op;
+        if (op == BOP_CALL || op == BOP_DEFINE || op == BOP_PRINT)
+            program->threadsafe = false;
+    }
+    return program;
+}
+
+void BatchCompiler::prepare(const YxlangNode* node, unsigned int level) {
+    if (!node)
+        return;
+
+    switch (node->type()) {
+        case NT_CONSTANT:
+            constant(static_cast<const CNConstant*>(node)->value);
+            return;
+        case NT_VARIABLE:
+            variable(static_cast<const CNVariable*>(node)->slot);
+            return;
+        case NT_ASSIGNMENT:
+            variable(static_cast<const CNAssignment*>(node)->slot);
+            break;
+        case NT_CONDITION:
+            ++level;
+            if (level > program->maxdepth)
+                program->maxdepth = level;
+            break;
+        case NT_SHARE:
+            if (!shares.count(static_cast<const CNShare*>(node))) {
+                uint32_t index = shares.size();
+                shares[static_cast<const CNShare*>(node)] = index;
+            }
+            break;
+        case NT_CUSTOMFUNCTION:
+            /* the body is run by the tree walker */
+            return;
+        default:
+            break;
+    }
+
+    bool call = node->type() == NT_CALLUDF;
+    YxlangNode::Children children(node);
+    unsigned int n = children.size();
+    for (unsigned int i = 0; i < n; ++i) {
+        if (children[i]) {
+            prepare(children[i], level);
+            call = call || calls.count(children[i]);
+        }
+    }
+    if (call)
+        calls.insert(node);
+}
+
+uint32_t BatchCompiler::constant(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    std::map<uint64_t, uint32_t>::const_iterator ci = constantindex.find(bits);
+    if (ci != constantindex.end())
+        return ci->second;
+    program->constants.push_back(value);
+    return constantindex[bits] = program->constants.size() - 1;
+}
+
+uint32_t BatchCompiler::variable(unsigned int slot) {
+    std::map<unsigned int, uint32_t>::const_iterator vi = variableindex.find(slot);
+    if (vi != variableindex.end())
+        return vi->second;
+    program->slots.push_back(slot);
+    return variableindex[slot] = program->slots.size() - 1;
+}
+
+uint32_t BatchCompiler::alloc() {
+    uint32_t t = tempbase + ntemps++;
+    if (ntemps > maxtemps)
+        maxtemps = ntemps;
+    return t;
+}
+
+int BatchCompiler::emit(BatchOpcode op, uint32_t d, uint32_t a, uint32_t b) {
+    BatchInstr instr;
+    instr.op = op;
+    instr.d = d;
+    instr.a = a;
+    instr.b = b;
+    program->code.push_back(instr);
+    return program->code.size() - 1;
+}
+
+uint32_t BatchCompiler::compileUnary(BatchOpcode op, const YxlangNode* left) {
+    uint32_t mark = ntemps;
+    uint32_t a = compileNode(left);
+    ntemps = mark;
+    /* the rows are independent, a result may overwrite its operand */
+    uint32_t d = alloc();
+    emit(op, d, a);
+    return d;
+}
+
+uint32_t BatchCompiler::compileBinary(BatchOpcode op, const YxlangNode* left, const YxlangNode* right) {
+    uint32_t mark = ntemps;
+    uint32_t a = compileNode(left);
+    /* a UDF called by the right operand may assign the variable */
+    if (left && left->type() == NT_VARIABLE && calls.count(right)) {
+        uint32_t t = alloc();
+        emit(BOP_MOVE, t, a);
+        a = t;
+    }
+    uint32_t b = compileNode(right);
+    ntemps = mark;
+    uint32_t d = alloc();
+    emit(op, d, a, b);
+    return d;
+}
+
+uint32_t BatchCompiler::compileNode(const YxlangNode* node) {
+    if (!node)
+        return constant(0);
+
+    switch (node->type()) {
+        case NT_CONSTANT:
+            return constant(static_cast<const CNConstant*>(node)->value);
+        case NT_VARIABLE:
+            return variable(static_cast<const CNVariable*>(node)->slot);
+        case NT_NEGATE:
+            return compileUnary(BOP_NEG, static_cast<const CNNegate*>(node)->node);
+        case NT_ADD: {
+            const CNAdd* n = static_cast<const CNAdd*>(node);
+            return compileBinary(BOP_ADD, n->left, n->right);
+        }
+        case NT_SUBTRACT: {
+            const CNSubtract* n = static_cast<const CNSubtract*>(node);
+            return compileBinary(BOP_SUB, n->left, n->right);
+        }
+        case NT_MULTIPLY: {
+            const CNMultiply* n = static_cast<const CNMultiply*>(node);
+            return compileBinary(BOP_MUL, n->left, n->right);
+        }
+        case NT_DIVIDE: {
+            const CNDivide* n = static_cast<const CNDivide*>(node);
+            return compileBinary(BOP_DIV, n->left, n->right);
+        }
+        case NT_MODULO: {
+            const CNModulo* n = static_cast<const CNModulo*>(node);
+            return compileBinary(BOP_MOD, n->left, n->right);
+        }
+        case NT_POWER: {
+            const CNPower* n = static_cast<const CNPower*>(node);
+            return compileBinary(BOP_POW, n->left, n->right);
+        }
+        case NT_BINARYFUNCTION: {
+            const CNBinaryFunction* n = static_cast<const CNBinaryFunction*>(node);
+            return compileBinary(BOP_POW, n->left, n->right);
+        }
+        case NT_COMPARE: {
+            const CNCompare* n = static_cast<const CNCompare*>(node);
+            BatchOpcode op = BOP_GT;
+            switch (n->fn) {
+                case CMP_GT: op = BOP_GT; break;
+                case CMP_LT: op = BOP_LT; break;
+                case CMP_NE: op = BOP_NE; break;
+                case CMP_EQ: op = BOP_EQ; break;
+                case CMP_GE: op = BOP_GE; break;
+                case CMP_LE: op = BOP_LE; break;
+            }
+            return compileBinary(op, n->left, n->right);
+        }
+        case NT_UNARYFUNCTION: {
+            const CNUnaryFunction* n = static_cast<const CNUnaryFunction*>(node);
+            BatchOpcode op = BOP_SQRT;
+            switch (n->fn) {
+                case UF_SQRT: op = BOP_SQRT; break;
+                case UF_EXP: op = BOP_EXP; break;
+                case UF_LOG: op = BOP_LOG; break;
+                case UF_PRINT: op = BOP_PRINT; break;
+            }
+            return compileUnary(op, n->left);
+        }
+        case NT_EXPRLIST:
+            return compileNode(static_cast<const CNExprlist*>(node)->left);
+        case NT_ASSIGNMENT: {
+            const CNAssignment* n = static_cast<const CNAssignment*>(node);
+            uint32_t var = variable(n->slot);
+            uint32_t mark = ntemps;
+            emit(BOP_MOVE, var, compileNode(n->left));
+            ntemps = mark;
+            return var;
+        }
+        case NT_CONDITION: {
+            const CNCondition* n = static_cast<const CNCondition*>(node);
+            uint32_t d = alloc();
+            uint32_t mark = ntemps;
+            int branch = emit(BOP_IF, 0, compileNode(n->cond));
+            ntemps = mark;
+            emit(BOP_MOVE, d, compileNode(n->left));
+            ntemps = mark;
+            int otherwise = emit(BOP_ELSE);
+            program->code[branch].b = otherwise;
+            emit(BOP_MOVE, d, compileNode(n->right));
+            ntemps = mark;
+            program->code[otherwise].b = emit(BOP_ENDIF);
+            return d;
+        }
+        case NT_BLOCK: {
+            const CNBlock* n = static_cast<const CNBlock*>(node);
+            uint32_t mark = ntemps;
+            for (unsigned int i = 0; i + 1 < n->count; ++i) {
+                compileNode(n->statements[i]);
+                ntemps = mark;
+            }
+            return compileNode(n->count ? n->statements[n->count - 1] : NULL);
+        }
+        /* parameters only occur in function bodies, the tree walker runs them */
+        case NT_PARAMETER:
+        case NT_PARAMASSIGN:
+        case NT_PARAMLIST:
+            return constant(0);
+        case NT_CUSTOMFUNCTION: {
+            program->functions.push_back(static_cast<const CNCustomFunction*>(node));
+            uint32_t d = alloc();
+            emit(BOP_DEFINE, d, program->functions.size() - 1);
+            return d;
+        }
+        case NT_GUARD: {
+            program->guards.push_back(static_cast<const CNGuard*>(node));
+            uint32_t d = alloc();
+            emit(BOP_GUARD, d, program->guards.size() - 1);
+            return d;
+        }
+        case NT_CALLUDF: {
+            const CNCallUDF* n = static_cast<const CNCallUDF*>(node);
+            uint32_t mark = ntemps;
+            std::vector<uint32_t> args;
+            for (CNCallUDF::Arguments arg(n); !arg.done(); arg.next()) {
+                uint32_t a = compileNode(arg.node());
+                /* a later argument may call a UDF that assigns the variable */
+                if (arg.node() && arg.node()->type() == NT_VARIABLE && calls.count(arg.rest())) {
+                    uint32_t t = alloc();
+                    emit(BOP_MOVE, t, a);
+                    a = t;
+                }
+                args.push_back(a);
+            }
+            uint32_t at = program->calls.size();
+            program->calls.push_back(n->symbol);
+            program->calls.insert(program->calls.end(), args.begin(), args.end());
+            ntemps = mark;
+            uint32_t d = alloc();
+            emit(BOP_CALL, d, at, args.size());
+            return d;
+        }
+        case NT_SHARE: {
+            const CNShare* n = static_cast<const CNShare*>(node);
+            uint32_t share = shares[n];
+            uint32_t mark = ntemps;
+            emit(BOP_MOVE, share, compileNode(n->node));
+            ntemps = mark;
+            return share;
+        }
+        case NT_SHAREREF:
+            return shares[static_cast<const CNShareRef*>(node)->share];
+    }
+    return constant(0);
+}
+
+void BatchProgram::run(YxlangContext &calc, const BatchColumns &columns, size_t begin, size_t end, double* out) const {
+    /* two more columns of scratch space for the math kernels */
+    std::vector<double> storage(static_cast<size_t>(ncolumns + 2) * BLOCK);
+    /* the row numbers of the true and false rows of each nesting level */
+    std::vector<uint32_t> selections(2 * maxdepth * BLOCK + 1);
+    std::vector<Level> levels(maxdepth + 1);
+    for (unsigned int c = 0; c < constants.size(); ++c)
+        std::fill(&storage[c * BLOCK], &storage[c * BLOCK] + BLOCK, constants[c]);
+
+    /* every row starts from the variables as they are now */
+    std::vector<const double*> bound(slots.size(), NULL);
+    std::vector<double> initial(slots.size());
+    for (unsigned int j = 0; j < slots.size(); ++j) {
+        BatchColumns::const_iterator ci = columns.find(slots[j]);
+        if (ci != columns.end())
+            bound[j] = ci->second;
+        initial[j] = calc.variables[slots[j]];
+    }
+    /* a UDF may assign the variables assigned in any function body that
+     * can run during the batch, every row gets its own copy of those the
+     * expression has no column for */
+    RowVariables rowvars;
+    std::vector<double> saved;
+    if (!calls.empty()) {
+        std::set<unsigned int> writes;
+        for (YxlangContext::functionmap_type::const_iterator fi = calc.functions.begin(); fi != calc.functions.end(); ++fi)
+            assigned(fi->second->right, writes);
+        for (unsigned int i = 0; i < functions.size(); ++i)
+            assigned(functions[i]->right, writes);
+        for (unsigned int j = 0; j < slots.size(); ++j)
+            writes.erase(slots[j]);
+        rowvars.slots.assign(writes.begin(), writes.end());
+        for (unsigned int j = 0; j < rowvars.slots.size(); ++j)
+            saved.push_back(calc.variables[rowvars.slots[j]]);
+        rowvars.values.resize(saved.size() * BLOCK);
+    }
+
+    double* varcolumns = &storage[constants.size() * BLOCK];
+    for (size_t row = begin; row < end; row += BLOCK) {
+        unsigned int n = std::min<size_t>(BLOCK, end - row);
+        for (unsigned int j = 0; j < slots.size(); ++j) {
+            double* column = varcolumns + j * BLOCK;
+            if (bound[j])
+                memcpy(column, bound[j] + row, n * sizeof(double));
+            else
+                std::fill(column, column + n, initial[j]);
+        }
+        for (unsigned int r = 0; r < n && !saved.empty(); ++r)
+            std::copy(saved.begin(), saved.end(), rowvars.values.begin() + r * saved.size());
+        execute(calc, &storage[0], &selections[0], &levels[0], n, rowvars);
+        memcpy(out + row, &storage[result * BLOCK], n * sizeof(double));
+    }
+
+    /* the calls left the variables of the last row behind */
+    if (!calls.empty()) {
+        for (unsigned int j = 0; j < slots.size(); ++j)
+            calc.variables[slots[j]] = initial[j];
+        for (unsigned int j = 0; j < rowvars.slots.size(); ++j)
+            calc.variables[rowvars.slots[j]] = saved[j];
+    }
+}
+
+void BatchProgram::execute(YxlangContext &calc, double* storage, uint32_t* selections, Level* levels, unsigned int n, RowVariables &rowvars) const {
+    unsigned int depth = 0;
+    const VecMath &math = calc.getVecMath();
+    double* scratch = storage + static_cast<size_t>(ncolumns) * BLOCK;
+
+    /* NULL selects all n rows */
+    const uint32_t* sel = NULL;
+    unsigned int count = n;
+
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        const BatchInstr &instr = code[pc];
+        double* d = storage + static_cast<size_t>(instr.d) * BLOCK;
+        const double* a = storage + static_cast<size_t>(instr.a) * BLOCK;
+        const double* b = storage + static_cast<size_t>(instr.b) * BLOCK;
+        switch (instr.op) {
+            case BOP_MOVE: unary<OpMove>(d, a, sel, count); break;
+            case BOP_NEG: unary<OpNegate>(d, a, sel, count); break;
+            case BOP_SQRT: kernel(math.sqrt, d, a, sel, count, scratch); break;
+            case BOP_EXP: kernel(math.exp, d, a, sel, count, scratch); break;
+            case BOP_LOG: kernel(math.log, d, a, sel, count, scratch); break;
+            case BOP_PRINT:
+                for (unsigned int k = 0; k < count; ++k) {
+                    uint32_t r = sel ? sel[k] : k;
+                    d[r] = a[r];
+                    std::cout << "= " << d[r] << std::endl;
+                }
+                break;
+            case BOP_ADD: binary<OpAdd>(d, a, b, sel, count); break;
+            case BOP_SUB: binary<OpSubtract>(d, a, b, sel, count); break;
+            case BOP_MUL: binary<OpMultiply>(d, a, b, sel, count); break;
+            case BOP_DIV: binary<OpDivide>(d, a, b, sel, count); break;
+            case BOP_MOD: binary<OpModulo>(d, a, b, sel, count); break;
+            case BOP_POW: kernel(math.pow, d, a, b, sel, count, scratch); break;
+            case BOP_GT: binary<OpGT>(d, a, b, sel, count); break;
+            case BOP_LT: binary<OpLT>(d, a, b, sel, count); break;
+            case BOP_NE: binary<OpNE>(d, a, b, sel, count); break;
+            case BOP_EQ: binary<OpEQ>(d, a, b, sel, count); break;
+            case BOP_GE: binary<OpGE>(d, a, b, sel, count); break;
+            case BOP_LE: binary<OpLE>(d, a, b, sel, count); break;
+            case BOP_IF: {
+                Level &level = levels[depth];
+                uint32_t* truesel = selections + 2 * depth * BLOCK;
+                uint32_t* falsesel = truesel + BLOCK;
+                ++depth;
+                level.sel = sel;
+                level.count = count;
+                level.ntrue = level.nfalse = 0;
+                for (unsigned int k = 0; k < count; ++k) {
+                    uint32_t r = sel ? sel[k] : k;
+                    if (YxlangNode::truth(a[r]))
+                        truesel[level.ntrue++] = r;
+                    else
+                        falsesel[level.nfalse++] = r;
+                }
+                /* a branch taken by every row keeps the dense selection */
+                level.truesel = level.nfalse ? truesel : sel;
+                level.falsesel = level.ntrue ? falsesel : sel;
+                sel = level.truesel;
+                count = level.ntrue;
+                if (!count)
+                    pc = instr.b - 1;
+                break;
+            }
+            case BOP_ELSE: {
+                const Level &level = levels[depth - 1];
+                sel = level.falsesel;
+                count = level.nfalse;
+                if (!count)
+                    pc = instr.b - 1;
+                break;
+            }
+            case BOP_ENDIF: {
+                const Level &level = levels[--depth];
+                sel = level.sel;
+                count = level.count;
+                break;
+            }
+            case BOP_CALL:
+                call(calc, instr, storage, sel, count, rowvars);
+                break;
+            case BOP_DEFINE:
+                if (count)
+                    functions[instr.a]->evaluate(calc);
+                unary<OpMove>(d, storage, sel, count);
+                break;
+            case BOP_GUARD: {
+                double v = guards[instr.a]->check(calc) ? 1 : 0;
+                for (unsigned int k = 0; k < count; ++k)
+                    d[sel ? sel[k] : k] = v;
+                break;
+            }
+        }
+    }
+}
+
+void BatchProgram::call(YxlangContext &calc, const BatchInstr &instr, double* storage, const uint32_t* sel, unsigned int n, RowVariables &rowvars) const {
+    double* d = storage + static_cast<size_t>(instr.d) * BLOCK;
+    const uint32_t* c = &calls[instr.a];
+    unsigned int nargs = instr.b;
+    YxlangContext::functionmap_type::const_iterator fi = calc.functions.find(c[0]);
+    if (fi == calc.functions.end()) {
+        unary<OpMove>(d, storage, sel, n);
+        return;
+    }
+
+    double* vars = calc.variables.data();
+    size_t nrow = rowvars.slots.size();
+    double* varcolumns = storage + constants.size() * BLOCK;
+    std::vector<double> args(nargs + 1);
+    for (unsigned int k = 0; k < n; ++k) {
+        uint32_t r = sel ? sel[k] : k;
+        for (unsigned int i = 0; i < nargs; ++i)
+            args[i] = storage[static_cast<size_t>(c[i + 1]) * BLOCK + r];
+        /* the UDF sees the variables of this row and nothing of the others,
+         * the ones it cannot assign are the same in every row */
+        double* row = nrow ? &rowvars.values[r * nrow] : NULL;
+        for (unsigned int j = 0; j < slots.size(); ++j)
+            vars[slots[j]] = varcolumns[j * BLOCK + r];
+        for (size_t j = 0; j < nrow; ++j)
+            vars[rowvars.slots[j]] = row[j];
+        d[r] = fi->second->invoke(calc, &args[0], nargs);
+        for (unsigned int j = 0; j < slots.size(); ++j)
+            varcolumns[j * BLOCK + r] = vars[slots[j]];
+        for (size_t j = 0; j < nrow; ++j)
+            row[j] = vars[rowvars.slots[j]];
+    }
+}
@@ -0,0 +1,164 @@
+/**
+ * @file batch.h
+ * @brief vector-at-a-time evaluation of one expression over many rows
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdint.h>
+#include <vector>
+#include <map>
+#include <set>
+#include "expression.h"
+
+/** batch opcodes. Operands are columns of the block, every operation only
+ * touches the rows of the current selection. */
+enum BatchOpcode {
+    /// d = a
+    BOP_MOVE,
+    /// d = op a
+    BOP_NEG,
+    BOP_SQRT,
+    BOP_EXP,
+    BOP_LOG,
+    BOP_PRINT,
+    /// d = a op b
+    BOP_ADD,
+    BOP_SUB,
+    BOP_MUL,
+    BOP_DIV,
+    BOP_MOD,
+    BOP_POW,
+    BOP_GT,
+    BOP_LT,
+    BOP_NE,
+    BOP_EQ,
+    BOP_GE,
+    BOP_LE,
+    /// split the selection by a into the rows where it is true and where
+    /// it is false, select the true ones. Continue at b if there are none.
+    BOP_IF,
+    /// select the false rows of the innermost IF, continue at b if none
+    BOP_ELSE,
+    /// restore the selection from before the innermost IF
+    BOP_ENDIF,
+    /// d = UDF with symbol id calls[a] on the b columns calls[a+1] .., row by row
+    BOP_CALL,
+    /// register functions[a], d = 0
+    BOP_DEFINE,
+    /// d = 1 if the inlined function of guards[a] is still defined, else 0
+    BOP_GUARD
+};
+
+/** one batch instruction, all operands are column indices */
+struct BatchInstr {
+    uint8_t	op;
+    uint32_t	d;
+    uint32_t	a;
+    uint32_t	b;
+};
+
+/** variable slot to a column of values, one per row */
+typedef std::map<unsigned int, const double*>	BatchColumns;
+
+/** One expression compiled for evaluation over blocks of rows. Every
+ * operator runs over a whole block at once, so the dispatch cost is paid
+ * once per block instead of once per row. A condition splits the rows
+ * into selection vectors and runs each branch only on its rows.
+ *
+ * Each row starts from the variables as they were before the batch, with
+ * the bound variables set to the row's values. Assignments only affect
+ * their own row, also those made by a UDF, and the variables are left as
+ * they were afterwards. A function defined by the expression is registered
+ * when the first block reaches the definition. print prints one operator
+ * at a time for all rows of a block. */
+class BatchProgram {
+public:
+    enum {
+        BLOCK = 1024,
+        /// rows per task when a batch is split across threads
+        MORSEL = 16 * BLOCK
+    };
+
+    std::vector<BatchInstr>	code;
+    std::vector<double>	constants;
+    /// slots of all variables the expression reads or assigns
+    std::vector<unsigned int>	slots;
+    /// symbol ids and argument columns of the calls
+    std::vector<uint32_t>	calls;
+    std::vector<const CNCustomFunction*>	functions;
+    std::vector<const CNGuard*>	guards;
+    /// number of columns, constants first, then the variables in slots
+    /// order, then shared subexpressions and temporaries
+    uint32_t	ncolumns;
+    /// column holding the result
+    uint32_t	result;
+    /// deepest nesting of conditions
+    unsigned int	maxdepth;
+    /// no UDF calls, definitions or print, so disjoint row ranges can run
+    /// at the same time
+    bool	threadsafe;
+
+    BatchProgram() : ncolumns(0), result(0), maxdepth(0), threadsafe(true) {
+    }
+
+    /** evaluate rows [begin, end) against the variables and functions of
+     * calc. columns must hold values for these rows, the value of row r is
+     * written to out[r]. Only reads the variables if threadsafe. */
+    void	run(YxlangContext &calc, const BatchColumns &columns, size_t begin, size_t end, double* out) const;
+
+private:
+    /** selection of one nesting level of conditions */
+    struct Level {
+        const uint32_t*	sel;
+        unsigned int	count;
+        const uint32_t*	truesel;
+        unsigned int	ntrue;
+        const uint32_t*	falsesel;
+        unsigned int	nfalse;
+    };
+
+    /** the variables the called UDFs may assign that have no column,
+     * with their values in each row of the block, row by row */
+    struct RowVariables {
+        std::vector<unsigned int>	slots;
+        std::vector<double>	values;
+    };
+
+    void	execute(YxlangContext &calc, double* storage, uint32_t* selections, Level* levels, unsigned int n, RowVariables &rowvars) const;
+    void	call(YxlangContext &calc, const BatchInstr &instr, double* storage, const uint32_t* sel, unsigned int n, RowVariables &rowvars) const;
+};
+
+/** compiles a Yxlang tree into a BatchProgram */
+class BatchCompiler {
+public:
+    static BatchProgram* compile(const YxlangNode* node);
+
+private:
+    explicit BatchCompiler(BatchProgram* _program) : program(_program), tempbase(0), ntemps(0), maxtemps(0) {
+    }
+
+    void	prepare(const YxlangNode* node, unsigned int level);
+    uint32_t	constant(double value);
+    uint32_t	variable(unsigned int slot);
+    uint32_t	alloc();
+    uint32_t	compileNode(const YxlangNode* node);
+    uint32_t	compileUnary(BatchOpcode op, const YxlangNode* left);
+    uint32_t	compileBinary(BatchOpcode op, const YxlangNode* left, const YxlangNode* right);
+    int	emit(BatchOpcode op, uint32_t d = 0, uint32_t a = 0, uint32_t b = 0);
+
+    BatchProgram*	program;
+    std::map<uint64_t, uint32_t>	constantindex;
+    std::map<unsigned int, uint32_t>	variableindex;
+    std::map<const CNShare*, uint32_t>	shares;
+    /// subtrees that call a UDF and so may change any variable
+    std::set<const YxlangNode*>	calls;
+    uint32_t	tempbase;
+    uint32_t	ntemps;
+    uint32_t	maxtemps;
+};
+
+#endif // BATCH_H
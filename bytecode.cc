@@ -0,0 +1,448 @@
+/**
+ * @file bytecode.cc
+ * @brief bytecode compiler and stack VM
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <cmath>
+#include <iostream>
+#include "bytecode.h"
+
+StackProgram* StackCompiler::compile(YxlangContext &calc, const YxlangNode* node) {
+    StackProgram* program = new StackProgram();
+    StackCompiler compiler(calc, program);
+    compiler.prepare(node);
+    compiler.compileNode(node);
+    compiler.emit(OP_HALT);
+    /* a jump to the end returns right away */
+    std::vector<StackInstr> &code = program->code;
+    for (unsigned int i = 0; i < code.size(); ++i) {
+        if (code[i].op != OP_JUMP)
+            continue;
+        while (code[code[i].arg].op == OP_JUMP)
+            code[i].arg = code[code[i].arg].arg;
+        if (code[code[i].arg].op == OP_HALT)
+            code[i].op = OP_HALT;
+    }
+    program->stack.resize(program->maxdepth + 1);
+    return program;
+}
+
+bool StackCompiler::prepare(const YxlangNode* node) {
+    if (!node)
+        return false;
+
+    bool write = node->type() == NT_ASSIGNMENT || node->type() == NT_SHARE || node->type() == NT_CALLUDF;
+    YxlangNode::Children children(node);
+    unsigned int count = children.size();
+    for (unsigned int i = 0; i < count; ++i) {
+        if (prepare(children[i]))
+            write = true;
+    }
+    if (write)
+        writes.insert(node);
+    return write;
+}
+
+int StackCompiler::emit(StackOpcode op, double* d, const double* a, const double* b, int arg, unsigned short count) {
+    StackInstr instr;
+    instr.handler = NULL;
+    instr.op = op;
+    instr.count = count;
+    instr.arg = arg;
+    instr.d = d;
+    instr.a = a;
+    instr.b = b;
+    program->code.push_back(instr);
+    return program->code.size() - 1;
+}
+
+const double* StackCompiler::operand(const YxlangNode* node) {
+    if (!node) {
+        program->constants.push_back(0);
+        return &program->constants.back();
+    }
+    switch (node->type()) {
+        case NT_CONSTANT:
+            program->constants.push_back(static_cast<const CNConstant*>(node)->value);
+            return &program->constants.back();
+        case NT_VARIABLE:
+            return &calc.variables[static_cast<const CNVariable*>(node)->slot];
+        case NT_SHAREREF:
+            return &static_cast<const CNShareRef*>(node)->share->value;
+        default:
+            return NULL;
+    }
+}
+
+StackOpcode StackCompiler::compare(int fn) {
+    switch (fn) {
+        case CMP_LT: return OP_LT;
+        case CMP_NE: return OP_NE;
+        case CMP_EQ: return OP_EQ;
+        case CMP_GE: return OP_GE;
+        case CMP_LE: return OP_LE;
+        default: return OP_GT;
+    }
+}
+
+void StackCompiler::push(unsigned int n) {
+    depth += n;
+    if (depth > program->maxdepth)
+        program->maxdepth = depth;
+}
+
+int StackCompiler::compileBinary(StackOpcode op, const YxlangNode* left, const YxlangNode* right) {
+    bool leaf = !left || left->type() == NT_CONSTANT || left->type() == NT_VARIABLE || left->type() == NT_SHAREREF;
+    /* the tree walker reads the left operand first, so it can only be read
+     * after the right one when that cannot change it */
+    if (leaf && (!writes.count(right) || !left || left->type() == NT_CONSTANT)) {
+        const double* a = operand(left);
+        const double* b = operand(right);
+        if (b) {
+            push();
+            return emit(static_cast<StackOpcode>(op + FORM_MM), NULL, a, b);
+        }
+        compileNode(right);
+        return emit(static_cast<StackOpcode>(op + FORM_MS), NULL, a);
+    }
+
+    compileNode(left);
+    const double* b = operand(right);
+    if (b)
+        return emit(static_cast<StackOpcode>(op + FORM_SM), NULL, NULL, b);
+    compileNode(right);
+    pop();
+    return emit(static_cast<StackOpcode>(op + FORM_SS));
+}
+
+void StackCompiler::compileNode(const YxlangNode* node) {
+    const double* p = operand(node);
+    if (p) {
+        emit(OP_LOAD, NULL, p);
+        push();
+        return;
+    }
+
+    switch (node->type()) {
+        case NT_NEGATE: {
+            compileNode(static_cast<const CNNegate*>(node)->node);
+            emit(OP_NEG);
+            break;
+        }
+        case NT_ADD: {
+            const CNAdd* n = static_cast<const CNAdd*>(node);
+            compileBinary(OP_ADD, n->left, n->right);
+            break;
+        }
+        case NT_SUBTRACT: {
+            const CNSubtract* n = static_cast<const CNSubtract*>(node);
+            compileBinary(OP_SUB, n->left, n->right);
+            break;
+        }
+        case NT_MULTIPLY: {
+            const CNMultiply* n = static_cast<const CNMultiply*>(node);
+            compileBinary(OP_MUL, n->left, n->right);
+            break;
+        }
+        case NT_DIVIDE: {
+            const CNDivide* n = static_cast<const CNDivide*>(node);
+            compileBinary(OP_DIV, n->left, n->right);
+            break;
+        }
+        case NT_MODULO: {
+            const CNModulo* n = static_cast<const CNModulo*>(node);
+            compileBinary(OP_MOD, n->left, n->right);
+            break;
+        }
+        case NT_POWER: {
+            const CNPower* n = static_cast<const CNPower*>(node);
+            compileBinary(OP_POW, n->left, n->right);
+            break;
+        }
+        case NT_COMPARE: {
+            const CNCompare* n = static_cast<const CNCompare*>(node);
+            compileBinary(compare(n->fn), n->left, n->right);
+            break;
+        }
+        case NT_UNARYFUNCTION: {
+            const CNUnaryFunction* n = static_cast<const CNUnaryFunction*>(node);
+            compileNode(n->left);
+            switch (n->fn) {
+                case UF_SQRT: emit(OP_SQRT); break;
+                case UF_EXP: emit(OP_EXP); break;
+                case UF_LOG: emit(OP_LOG); break;
+                case UF_PRINT: emit(OP_PRINT); break;
+            }
+            break;
+        }
+        case NT_BINARYFUNCTION: {
+            const CNBinaryFunction* n = static_cast<const CNBinaryFunction*>(node);
+            compileBinary(OP_POW, n->left, n->right);
+            break;
+        }
+        case NT_EXPRLIST: {
+            compileNode(static_cast<const CNExprlist*>(node)->left);
+            break;
+        }
+        case NT_ASSIGNMENT: {
+            const CNAssignment* n = static_cast<const CNAssignment*>(node);
+            compileNode(n->left);
+            emit(OP_STORE, &calc.variables[n->slot]);
+            break;
+        }
+        case NT_CONDITION: {
+            const CNCondition* n = static_cast<const CNCondition*>(node);
+            int jumpf;
+            if (n->cond && n->cond->type() == NT_COMPARE) {
+                /* compare and branch in one instruction */
+                const CNCompare* c = static_cast<const CNCompare*>(n->cond);
+                jumpf = compileBinary(static_cast<StackOpcode>(compare(c->fn) - OP_GT + OP_JUMPF_GT), c->left, c->right);
+            } else {
+                compileNode(n->cond);
+                jumpf = emit(OP_JUMPF);
+            }
+            pop();
+            compileNode(n->left);
+            int jump = emit(OP_JUMP);
+            pop();
+            patch(jumpf);
+            compileNode(n->right);
+            patch(jump);
+            break;
+        }
+        case NT_BLOCK: {
+            const CNBlock* n = static_cast<const CNBlock*>(node);
+            for (unsigned int i = 0; i + 1 < n->count; ++i) {
+                compileNode(n->statements[i]);
+                emit(OP_POP);
+                pop();
+            }
+            compileNode(n->count ? n->statements[n->count - 1] : NULL);
+            break;
+        }
+        /* parameters only occur in function bodies, the tree walker runs them */
+        case NT_PARAMETER:
+        case NT_PARAMASSIGN:
+        case NT_PARAMLIST: {
+            compileNode(NULL);
+            break;
+        }
+        case NT_CUSTOMFUNCTION: {
+            program->functions.push_back(static_cast<const CNCustomFunction*>(node));
+            emit(OP_DEFINE, NULL, NULL, NULL, program->functions.size() - 1);
+            push();
+            break;
+        }
+        case NT_GUARD: {
+            program->guards.push_back(static_cast<const CNGuard*>(node));
+            emit(OP_GUARD, NULL, NULL, NULL, program->guards.size() - 1);
+            push();
+            break;
+        }
+        case NT_SHARE: {
+            const CNShare* n = static_cast<const CNShare*>(node);
+            compileNode(n->node);
+            emit(OP_STORE, &n->value);
+            break;
+        }
+        case NT_CALLUDF: {
+            const CNCallUDF* n = static_cast<const CNCallUDF*>(node);
+            unsigned short nargs = 0;
+            for (CNCallUDF::Arguments a(n); !a.done(); a.next()) {
+                compileNode(a.node());
+                ++nargs;
+            }
+            emit(OP_CALL, NULL, NULL, NULL, n->symbol, nargs);
+            /* the arguments are stored below the result before the call */
+            push();
+            pop(nargs);
+            break;
+        }
+        default: {
+            compileNode(NULL);
+            break;
+        }
+    }
+}
+
+double StackProgram::run(YxlangContext &calc) {
+    static const void* const labels[OP_COUNT] = {
+        &&op_load, &&op_store, &&op_pop,
+        &&op_neg, &&op_sqrt, &&op_exp, &&op_log, &&op_print,
+        &&op_add_ss, &&op_add_sm, &&op_add_ms, &&op_add_mm,
+        &&op_sub_ss, &&op_sub_sm, &&op_sub_ms, &&op_sub_mm,
+        &&op_mul_ss, &&op_mul_sm, &&op_mul_ms, &&op_mul_mm,
+        &&op_div_ss, &&op_div_sm, &&op_div_ms, &&op_div_mm,
+        &&op_mod_ss, &&op_mod_sm, &&op_mod_ms, &&op_mod_mm,
+        &&op_pow_ss, &&op_pow_sm, &&op_pow_ms, &&op_pow_mm,
+        &&op_gt_ss, &&op_gt_sm, &&op_gt_ms, &&op_gt_mm,
+        &&op_lt_ss, &&op_lt_sm, &&op_lt_ms, &&op_lt_mm,
+        &&op_ne_ss, &&op_ne_sm, &&op_ne_ms, &&op_ne_mm,
+        &&op_eq_ss, &&op_eq_sm, &&op_eq_ms, &&op_eq_mm,
+        &&op_ge_ss, &&op_ge_sm, &&op_ge_ms, &&op_ge_mm,
+        &&op_le_ss, &&op_le_sm, &&op_le_ms, &&op_le_mm,
+        &&op_jumpf_gt_ss, &&op_jumpf_gt_sm, &&op_jumpf_gt_ms, &&op_jumpf_gt_mm,
+        &&op_jumpf_lt_ss, &&op_jumpf_lt_sm, &&op_jumpf_lt_ms, &&op_jumpf_lt_mm,
+        &&op_jumpf_ne_ss, &&op_jumpf_ne_sm, &&op_jumpf_ne_ms, &&op_jumpf_ne_mm,
+        &&op_jumpf_eq_ss, &&op_jumpf_eq_sm, &&op_jumpf_eq_ms, &&op_jumpf_eq_mm,
+        &&op_jumpf_ge_ss, &&op_jumpf_ge_sm, &&op_jumpf_ge_ms, &&op_jumpf_ge_mm,
+        &&op_jumpf_le_ss, &&op_jumpf_le_sm, &&op_jumpf_le_ms, &&op_jumpf_le_mm,
+        &&op_jump, &&op_jumpf, &&op_call, &&op_define, &&op_guard, &&op_halt
+    };
+    if (!threaded) {
+        for (unsigned int i = 0; i < code.size(); ++i)
+            code[i].handler = labels[code[i].op];
+        threaded = true;
+    }
+
+    const StackInstr* base = &code[0];
+    const StackInstr* pc = base;
+    /* the top of the stack, sp points past the values below it */
+    double top = 0;
+    double* sp = &stack[0];
+
+#define DISPATCH()  goto *pc->handler
+#define NEXT()      do { ++pc; DISPATCH(); } while (0)
+/* the four forms of a binary operator, l and r name its operands */
+#define BINARY(name, expr) \
+op_##name##_ss: { \
+        double l = *--sp, r = top; \
+        top = (expr); \
+    } \
+    NEXT(); \
+op_##name##_sm: { \
+        double l = top, r = *pc->b; \
+        top = (expr); \
+    } \
+    NEXT(); \
+op_##name##_ms: { \
+        double l = *pc->a, r = top; \
+        top = (expr); \
+    } \
+    NEXT(); \
+op_##name##_mm: { \
+        double l = *pc->a, r = *pc->b; \
+        *sp++ = top; \
+        top = (expr); \
+    } \
+    NEXT();
+/* the four forms of a compare and branch, jumping unless l op r */
+#define BRANCH(name, op) \
+op_jumpf_##name##_ss: { \
+        double l = sp[-1], r = top; \
+        sp -= 2; \
+        top = *sp; \
+        if (!(l op r)) { \
+            pc = base + pc->arg; \
+            DISPATCH(); \
+        } \
+    } \
+    NEXT(); \
+op_jumpf_##name##_sm: { \
+        double l = top, r = *pc->b; \
+        top = *--sp; \
+        if (!(l op r)) { \
+            pc = base + pc->arg; \
+            DISPATCH(); \
+        } \
+    } \
+    NEXT(); \
+op_jumpf_##name##_ms: { \
+        double l = *pc->a, r = top; \
+        top = *--sp; \
+        if (!(l op r)) { \
+            pc = base + pc->arg; \
+            DISPATCH(); \
+        } \
+    } \
+    NEXT(); \
+op_jumpf_##name##_mm: \
+    if (!(*pc->a op *pc->b)) { \
+        pc = base + pc->arg; \
+        DISPATCH(); \
+    } \
+    NEXT();
+
+    DISPATCH();
+
+op_load:
+    *sp++ = top;
+    top = *pc->a;
+    NEXT();
+op_store:
+    *pc->d = top;
+    NEXT();
+op_pop:
+    top = *--sp;
+    NEXT();
+op_neg:
+    top = - top;
+    NEXT();
+op_sqrt:
+    top = std::sqrt(top);
+    NEXT();
+op_exp:
+    top = std::exp(top);
+    NEXT();
+op_log:
+    top = std::log(top);
+    NEXT();
+op_print:
+    std::cout << "= " << top << std::endl;
+    NEXT();
+BINARY(add, l + r)
+BINARY(sub, l - r)
+BINARY(mul, l * r)
+BINARY(div, l / r)
+BINARY(mod, std::fmod(l, r))
+BINARY(pow, std::pow(l, r))
+BINARY(gt, l > r ? 1 : 0)
+BINARY(lt, l < r ? 1 : 0)
+BINARY(ne, l != r ? 1 : 0)
+BINARY(eq, l == r ? 1 : 0)
+BINARY(ge, l >= r ? 1 : 0)
+BINARY(le, l <= r ? 1 : 0)
+BRANCH(gt, >)
+BRANCH(lt, <)
+BRANCH(ne, !=)
+BRANCH(eq, ==)
+BRANCH(ge, >=)
+BRANCH(le, <=)
+op_jump:
+    pc = base + pc->arg;
+    DISPATCH();
+op_jumpf: {
+        double c = top;
+        top = *--sp;
+        if (!YxlangNode::truth(c)) {
+            pc = base + pc->arg;
+            DISPATCH();
+        }
+    }
+    NEXT();
+op_call: {
+        /* the arguments go to memory in a row, the result takes their place */
+        *sp++ = top;
+        sp -= pc->count;
+        YxlangContext::functionmap_type::const_iterator fi = calc.functions.find(pc->arg);
+        top = fi == calc.functions.end() ? 0 : fi->second->invoke(calc, sp, pc->count);
+    }
+    NEXT();
+op_define:
+    *sp++ = top;
+    top = functions[pc->arg]->evaluate(calc);
+    NEXT();
+op_guard:
+    *sp++ = top;
+    top = guards[pc->arg]->check(calc) ? 1 : 0;
+    NEXT();
+op_halt:
+    return top;
+
+#undef BRANCH
+#undef BINARY
+#undef NEXT
+#undef DISPATCH
+}
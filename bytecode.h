@@ -0,0 +1,148 @@
+/**
+ * @file bytecode.h
+ * @brief bytecode compiler and stack VM
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <set>
+#include "expression.h"
+
+/** stack VM opcodes. The top of the stack is kept in a register, an
+ * operand that is a constant, a variable or a shared value is read
+ * straight from memory through a or b, so leaves need no instructions. */
+enum StackOpcode {
+    /// push *a
+    OP_LOAD,
+    /// assign the top of the stack to *d, keep it on the stack
+    OP_STORE,
+    /// drop the top of the stack
+    OP_POP,
+    /// replace the top of the stack by op top
+    OP_NEG,
+    OP_SQRT,
+    OP_EXP,
+    OP_LOG,
+    OP_PRINT,
+    /// the binary operators come in the forms of StackForm, in that order
+    OP_ADD,
+    OP_SUB = OP_ADD + 4,
+    OP_MUL = OP_SUB + 4,
+    OP_DIV = OP_MUL + 4,
+    OP_MOD = OP_DIV + 4,
+    OP_POW = OP_MOD + 4,
+    OP_GT = OP_POW + 4,
+    OP_LT = OP_GT + 4,
+    OP_NE = OP_LT + 4,
+    OP_EQ = OP_NE + 4,
+    OP_GE = OP_EQ + 4,
+    OP_LE = OP_GE + 4,
+    /// pop the operands of a comparison, continue at arg unless it holds,
+    /// in the forms of StackForm but pushing nothing
+    OP_JUMPF_GT = OP_LE + 4,
+    OP_JUMPF_LT = OP_JUMPF_GT + 4,
+    OP_JUMPF_NE = OP_JUMPF_LT + 4,
+    OP_JUMPF_EQ = OP_JUMPF_NE + 4,
+    OP_JUMPF_GE = OP_JUMPF_EQ + 4,
+    OP_JUMPF_LE = OP_JUMPF_GE + 4,
+    /// continue at arg
+    OP_JUMP = OP_JUMPF_LE + 4,
+    /// pop the condition, continue at arg if it is false
+    OP_JUMPF,
+    /// call the UDF with symbol id arg with the top count values as arguments
+    OP_CALL,
+    /// register the function definition functions[arg], push 0
+    OP_DEFINE,
+    /// push 1 if the inlined function of guards[arg] is still defined, else 0
+    OP_GUARD,
+    /// return the top of the stack
+    OP_HALT,
+    OP_COUNT
+};
+
+/** where the operands of a binary operator are, added to its opcode */
+enum StackForm {
+    /// left below the top of the stack, right on top, both are replaced
+    /// by the result
+    FORM_SS,
+    /// left on top of the stack, right *b, the top is replaced
+    FORM_SM,
+    /// left *a, right on top of the stack, the top is replaced
+    FORM_MS,
+    /// left *a, right *b, the result is pushed
+    FORM_MM
+};
+
+/** one stack VM instruction */
+struct StackInstr {
+    /// address of the handler, filled in when the code is threaded
+    const void*	handler;
+    unsigned short	op;
+    unsigned short	count;
+    int	arg;
+    double*	d;
+    const double*	a;
+    const double*	b;
+};
+
+/** bytecode of one expression and the VM running it */
+class StackProgram : public YxlangProgram {
+public:
+    std::vector<StackInstr>	code;
+    std::deque<double>	constants;
+    std::vector<const CNCustomFunction*>	functions;
+    std::vector<const CNGuard*>	guards;
+    /// deepest stack the code can reach
+    unsigned int	maxdepth;
+
+    StackProgram() : maxdepth(0), threaded(false) {
+    }
+
+    virtual double	run(YxlangContext &calc);
+
+private:
+    friend class StackCompiler;
+
+    std::vector<double>	stack;
+    bool	threaded;
+};
+
+/** lowers a Yxlang tree into StackProgram bytecode */
+class StackCompiler {
+public:
+    /** the program reads and writes the variables of calc */
+    static StackProgram* compile(YxlangContext &calc, const YxlangNode* node);
+
+private:
+    StackCompiler(YxlangContext &_calc, StackProgram* _program) : calc(_calc), program(_program), depth(0) {
+    }
+
+    bool	prepare(const YxlangNode* node);
+    void	compileNode(const YxlangNode* node);
+    int	compileBinary(StackOpcode op, const YxlangNode* left, const YxlangNode* right);
+    const double*	operand(const YxlangNode* node);
+    /** the opcode of a comparison of CNCompare::fn */
+    static StackOpcode	compare(int fn);
+    int	emit(StackOpcode op, double* d = NULL, const double* a = NULL, const double* b = NULL, int arg = 0, unsigned short count = 0);
+    void	patch(int at) {
+        program->code[at].arg = program->code.size();
+    }
+    void	push(unsigned int n = 1);
+    void	pop(unsigned int n = 1) {
+        depth -= n;
+    }
+
+    YxlangContext&	calc;
+    StackProgram*	program;
+    unsigned int	depth;
+    /// subtrees that may assign a variable or a shared value
+    std::set<const YxlangNode*>	writes;
+};
+
+#endif // BYTECODE_H
@@ -0,0 +1,283 @@
+/**
+ * @file closure.cc
+ * @brief closure compilation engine
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "closure.h"
+
+namespace {
+
+struct OpAdd { static double apply(double a, double b) { return a + b; } };
+struct OpSubtract { static double apply(double a, double b) { return a - b; } };
+struct OpMultiply { static double apply(double a, double b) { return a * b; } };
+struct OpDivide { static double apply(double a, double b) { return a / b; } };
+struct OpModulo { static double apply(double a, double b) { return std::fmod(a, b); } };
+struct OpPower { static double apply(double a, double b) { return std::pow(a, b); } };
+struct OpGT { static double apply(double a, double b) { return a > b ? 1 : 0; } };
+struct OpLT { static double apply(double a, double b) { return a < b ? 1 : 0; } };
+struct OpNE { static double apply(double a, double b) { return a != b ? 1 : 0; } };
+struct OpEQ { static double apply(double a, double b) { return a == b ? 1 : 0; } };
+struct OpGE { static double apply(double a, double b) { return a >= b ? 1 : 0; } };
+struct OpLE { static double apply(double a, double b) { return a <= b ? 1 : 0; } };
+struct OpNegate { static double apply(double a) { return - a; } };
+struct OpSqrt { static double apply(double a) { return std::sqrt(a); } };
+struct OpExp { static double apply(double a) { return std::exp(a); } };
+struct OpLog { static double apply(double a) { return std::log(a); } };
+
+/* one closure per combination of operand kinds. The left operand is
+ * always read before the right one is evaluated, like the tree walker. */
+template <class Op>
+ClosureOperand binary(const ClosureOperand &l, const ClosureOperand &r) {
+    typedef ClosureOperand O;
+    if (l.kind == O::CONSTANT) {
+        double a = l.value;
+        if (r.kind == O::CONSTANT)
+            return O::constant(Op::apply(a, r.value));
+        if (r.kind == O::VARIABLE) {
+            const double* b = r.variable;
+            return O::general([a, b]() { return Op::apply(a, *b); });
+        }
+        closure_type g = r.closure;
+        return O::general([a, g]() { return Op::apply(a, g()); });
+    }
+    if (l.kind == O::VARIABLE) {
+        const double* a = l.variable;
+        if (r.kind == O::CONSTANT) {
+            double b = r.value;
+            return O::general([a, b]() { return Op::apply(*a, b); });
+        }
+        if (r.kind == O::VARIABLE) {
+            const double* b = r.variable;
+            return O::general([a, b]() { return Op::apply(*a, *b); });
+        }
+        closure_type g = r.closure;
+        return O::general([a, g]() { double x = *a; return Op::apply(x, g()); });
+    }
+    closure_type f = l.closure;
+    if (r.kind == O::CONSTANT) {
+        double b = r.value;
+        return O::general([f, b]() { return Op::apply(f(), b); });
+    }
+    if (r.kind == O::VARIABLE) {
+        const double* b = r.variable;
+        return O::general([f, b]() { double x = f(); return Op::apply(x, *b); });
+    }
+    closure_type g = r.closure;
+    return O::general([f, g]() { double x = f(); return Op::apply(x, g()); });
+}
+
+template <class Op>
+ClosureOperand unary(const ClosureOperand &l) {
+    typedef ClosureOperand O;
+    if (l.kind == O::CONSTANT)
+        return O::constant(Op::apply(l.value));
+    if (l.kind == O::VARIABLE) {
+        const double* a = l.variable;
+        return O::general([a]() { return Op::apply(*a); });
+    }
+    closure_type f = l.closure;
+    return O::general([f]() { return Op::apply(f()); });
+}
+
+} // namespace
+
+ClosureProgram* ClosureCompiler::compile(YxlangContext &calc, const YxlangNode* node, const std::map<unsigned int, double*>* bound) {
+    ClosureCompiler compiler(calc, bound);
+    return new ClosureProgram(toClosure(compiler.compileNode(node)));
+}
+
+double* ClosureCompiler::variable(unsigned int slot) {
+    if (bound) {
+        std::map<unsigned int, double*>::const_iterator bi = bound->find(slot);
+        if (bi != bound->end())
+            return bi->second;
+    }
+    return &calc.variables[slot];
+}
+
+closure_type ClosureCompiler::toClosure(const ClosureOperand &o) {
+    if (o.kind == ClosureOperand::CONSTANT) {
+        double v = o.value;
+        return [v]() { return v; };
+    }
+    if (o.kind == ClosureOperand::VARIABLE) {
+        const double* p = o.variable;
+        return [p]() { return *p; };
+    }
+    return o.closure;
+}
+
+ClosureOperand ClosureCompiler::compileNode(const YxlangNode* node) {
+    typedef ClosureOperand O;
+    if (!node)
+        return O::constant(0);
+
+    switch (node->type()) {
+        case NT_CONSTANT:
+            return O::constant(static_cast<const CNConstant*>(node)->value);
+        case NT_VARIABLE:
+            return O::var(variable(static_cast<const CNVariable*>(node)->slot));
+        case NT_NEGATE:
+            return unary<OpNegate>(compileNode(static_cast<const CNNegate*>(node)->node));
+        case NT_ADD: {
+            const CNAdd* n = static_cast<const CNAdd*>(node);
+            return binary<OpAdd>(compileNode(n->left), compileNode(n->right));
+        }
+        case NT_SUBTRACT: {
+            const CNSubtract* n = static_cast<const CNSubtract*>(node);
+            return binary<OpSubtract>(compileNode(n->left), compileNode(n->right));
+        }
+        case NT_MULTIPLY: {
+            const CNMultiply* n = static_cast<const CNMultiply*>(node);
+            return binary<OpMultiply>(compileNode(n->left), compileNode(n->right));
+        }
+        case NT_DIVIDE: {
+            const CNDivide* n = static_cast<const CNDivide*>(node);
+            return binary<OpDivide>(compileNode(n->left), compileNode(n->right));
+        }
+        case NT_MODULO: {
+            const CNModulo* n = static_cast<const CNModulo*>(node);
+            return binary<OpModulo>(compileNode(n->left), compileNode(n->right));
+        }
+        case NT_POWER: {
+            const CNPower* n = static_cast<const CNPower*>(node);
+            return binary<OpPower>(compileNode(n->left), compileNode(n->right));
+        }
+        case NT_BINARYFUNCTION: {
+            const CNBinaryFunction* n = static_cast<const CNBinaryFunction*>(node);
+            return binary<OpPower>(compileNode(n->left), compileNode(n->right));
+        }
+        case NT_COMPARE: {
+            const CNCompare* n = static_cast<const CNCompare*>(node);
+            ClosureOperand l = compileNode(n->left);
+            ClosureOperand r = compileNode(n->right);
+            switch (n->fn) {
+                case CMP_GT: return binary<OpGT>(l, r);
+                case CMP_LT: return binary<OpLT>(l, r);
+                case CMP_NE: return binary<OpNE>(l, r);
+                case CMP_EQ: return binary<OpEQ>(l, r);
+                case CMP_GE: return binary<OpGE>(l, r);
+                case CMP_LE: return binary<OpLE>(l, r);
+            }
+            return O::constant(0);
+        }
+        case NT_UNARYFUNCTION: {
+            const CNUnaryFunction* n = static_cast<const CNUnaryFunction*>(node);
+            ClosureOperand l = compileNode(n->left);
+            switch (n->fn) {
+                case UF_SQRT: return unary<OpSqrt>(l);
+                case UF_EXP: return unary<OpExp>(l);
+                case UF_LOG: return unary<OpLog>(l);
+                case UF_PRINT: {
+                    closure_type f = toClosure(l);
+                    return O::general([f]() {
+                        double v = f();
+                        std::cout << "= " << v << std::endl;
+                        return v;
+                    });
+                }
+            }
+            return O::constant(0);
+        }
+        case NT_EXPRLIST:
+            return compileNode(static_cast<const CNExprlist*>(node)->left);
+        case NT_ASSIGNMENT: {
+            const CNAssignment* n = static_cast<const CNAssignment*>(node);
+            double* p = variable(n->slot);
+            ClosureOperand v = compileNode(n->left);
+            if (v.kind == O::CONSTANT) {
+                double x = v.value;
+                return O::general([p, x]() { return *p = x; });
+            }
+            if (v.kind == O::VARIABLE) {
+                const double* q = v.variable;
+                return O::general([p, q]() { return *p = *q; });
+            }
+            closure_type f = v.closure;
+            return O::general([p, f]() { return *p = f(); });
+        }
+        case NT_CONDITION: {
+            const CNCondition* n = static_cast<const CNCondition*>(node);
+            ClosureOperand c = compileNode(n->cond);
+            if (c.kind == O::CONSTANT)
+                return compileNode(YxlangNode::truth(c.value) ? n->left : n->right);
+            closure_type f = toClosure(c);
+            closure_type l = toClosure(compileNode(n->left));
+            closure_type r = toClosure(compileNode(n->right));
+            return O::general([f, l, r]() { return YxlangNode::truth(f()) ? l() : r(); });
+        }
+        case NT_BLOCK: {
+            const CNBlock* n = static_cast<const CNBlock*>(node);
+            std::vector<closure_type> effects;
+            for (unsigned int i = 0; i + 1 < n->count; ++i) {
+                ClosureOperand l = compileNode(n->statements[i]);
+                /* a constant or variable statement has no effect */
+                if (l.kind == O::CLOSURE)
+                    effects.push_back(l.closure);
+            }
+            ClosureOperand r = compileNode(n->count ? n->statements[n->count - 1] : NULL);
+            if (effects.empty())
+                return r;
+            closure_type g = toClosure(r);
+            if (effects.size() == 1) {
+                closure_type f = effects[0];
+                return O::general([f, g]() { f(); return g(); });
+            }
+            return O::general([effects, g]() {
+                for (size_t i = 0; i < effects.size(); ++i)
+                    effects[i]();
+                return g();
+            });
+        }
+        /* parameters only occur in function bodies, the tree walker runs them */
+        case NT_PARAMETER:
+        case NT_PARAMASSIGN:
+        case NT_PARAMLIST:
+            return O::constant(0);
+        case NT_CUSTOMFUNCTION: {
+            const CNCustomFunction* fn = static_cast<const CNCustomFunction*>(node);
+            YxlangContext* c = &calc;
+            return O::general([fn, c]() { return fn->evaluate(*c); });
+        }
+        case NT_GUARD: {
+            const CNGuard* guard = static_cast<const CNGuard*>(node);
+            YxlangContext* c = &calc;
+            return O::general([guard, c]() { return guard->check(*c) ? 1.0 : 0.0; });
+        }
+        case NT_SHARE: {
+            const CNShare* n = static_cast<const CNShare*>(node);
+            double* p = &n->value;
+            closure_type f = toClosure(compileNode(n->node));
+            return O::general([p, f]() { return *p = f(); });
+        }
+        case NT_SHAREREF:
+            return O::var(&static_cast<const CNShareRef*>(node)->share->value);
+        case NT_CALLUDF: {
+            const CNCallUDF* n = static_cast<const CNCallUDF*>(node);
+            std::vector<closure_type> args;
+            for (CNCallUDF::Arguments a(n); !a.done(); a.next())
+                args.push_back(toClosure(compileNode(a.node())));
+            unsigned int symbol = n->symbol;
+            YxlangContext* c = &calc;
+            return O::general([symbol, args, c]() {
+                double local[8];
+                std::vector<double> heap;
+                double* values = local;
+                if (args.size() > 8) {
+                    heap.resize(args.size());
+                    values = &heap[0];
+                }
+                for (unsigned int i = 0; i < args.size(); ++i)
+                    values[i] = args[i]();
+                YxlangContext::functionmap_type::const_iterator fi = c->functions.find(symbol);
+                return fi == c->functions.end() ? 0 : fi->second->invoke(*c, values, args.size());
+            });
+        }
+    }
+    return O::constant(0);
+}
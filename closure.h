@@ -0,0 +1,85 @@
+/**
+ * @file closure.h
+ * @brief closure compilation engine
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#ifndef CLOSURE_H
+#define CLOSURE_H
+
+#include <functional>
+#include <map>
+#include "expression.h"
+
+/** compiled subtree */
+typedef std::function<double()>	closure_type;
+
+/** nested closures of one expression */
+class ClosureProgram : public YxlangProgram {
+public:
+    closure_type	root;
+
+    explicit ClosureProgram(const closure_type &_root) : root(_root) {
+    }
+
+    /** the closures were bound to the context when they were compiled */
+    virtual double run(YxlangContext &) {
+        return root();
+    }
+};
+
+/** what a compiled subtree turned out to be. Parents specialize on the
+ * kinds of their operands, so constants and variables never cost a call. */
+struct ClosureOperand {
+    enum Kind { CONSTANT, VARIABLE, CLOSURE };
+
+    Kind	kind;
+    double	value;
+    double*	variable;
+    closure_type	closure;
+
+    static ClosureOperand constant(double _value) {
+        ClosureOperand o;
+        o.kind = CONSTANT;
+        o.value = _value;
+        o.variable = NULL;
+        return o;
+    }
+    static ClosureOperand var(double* _variable) {
+        ClosureOperand o;
+        o.kind = VARIABLE;
+        o.value = 0;
+        o.variable = _variable;
+        return o;
+    }
+    static ClosureOperand general(const closure_type &_closure) {
+        ClosureOperand o;
+        o.kind = CLOSURE;
+        o.value = 0;
+        o.variable = NULL;
+        o.closure = _closure;
+        return o;
+    }
+};
+
+/** turns a Yxlang tree into nested closures */
+class ClosureCompiler {
+public:
+    /** the closures read and write the variables of calc, those with a
+     * slot in bound at the address it maps to instead */
+    static ClosureProgram* compile(YxlangContext &calc, const YxlangNode* node, const std::map<unsigned int, double*>* bound = NULL);
+
+private:
+    ClosureCompiler(YxlangContext &_calc, const std::map<unsigned int, double*>* _bound) : calc(_calc), bound(_bound) {
+    }
+
+    ClosureOperand	compileNode(const YxlangNode* node);
+    double*	variable(unsigned int slot);
+    static closure_type	toClosure(const ClosureOperand &o);
+
+    YxlangContext&	calc;
+    const std::map<unsigned int, double*>*	bound;
+};
+
+#endif // CLOSURE_H
@@ -0,0 +1,212 @@
+/**
+ * @file cse.cc
+ * @brief common subexpression elimination over hash-consed subtrees
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <string.h>
+#include "cse.h"
+
+bool YxlangCSE::Key::operator<(const Key &other) const {
+    if (type != other.type)
+        return type < other.type;
+    if (fn != other.fn)
+        return fn < other.fn;
+    if (bits != other.bits)
+        return bits < other.bits;
+    for (unsigned int i = 0; i < 2; ++i) {
+        if (children[i] != other.children[i])
+            return children[i] < other.children[i];
+    }
+    return children[2] < other.children[2];
+}
+
+YxlangNode* YxlangCSE::eliminate(YxlangNode* node) {
+    table.clear();
+    ids.clear();
+    counts.clear();
+    reads.clear();
+    params.clear();
+    refs.clear();
+
+    hashcons(node);
+    available_type available;
+    share(&node, available);
+    int nextid = 0;
+    cleanup(&node, nextid);
+    return node;
+}
+
+int YxlangCSE::hashcons(const YxlangNode* node) {
+    if (!node)
+        return -1;
+
+    Key key;
+    key.type = node->type();
+    key.fn = 0;
+    key.bits = 0;
+    key.children[0] = key.children[1] = key.children[2] = -1;
+
+    YxlangNode::Children children(node);
+    unsigned int n = children.size();
+    bool hashable = true;
+    for (unsigned int i = 0; i < n; ++i) {
+        int id = hashcons(children[i]);
+        /* a block has more children than a key, it is never hashed */
+        if (i < 3)
+            key.children[i] = id;
+        hashable = hashable && id >= 0;
+    }
+
+    switch (node->type()) {
+        case NT_CONSTANT: {
+            double value = static_cast<const CNConstant*>(node)->value;
+            memcpy(&key.bits, &value, sizeof(key.bits));
+            break;
+        }
+        case NT_VARIABLE:
+            key.fn = static_cast<const CNVariable*>(node)->slot;
+            break;
+        case NT_PARAMETER:
+            key.fn = static_cast<const CNParameter*>(node)->index;
+            break;
+        case NT_COMPARE:
+            key.fn = static_cast<const CNCompare*>(node)->fn;
+            break;
+        case NT_UNARYFUNCTION:
+            key.fn = static_cast<const CNUnaryFunction*>(node)->fn;
+            hashable = hashable && key.fn != UF_PRINT;
+            break;
+        case NT_BINARYFUNCTION:
+            key.fn = static_cast<const CNBinaryFunction*>(node)->fn;
+            break;
+        case NT_NEGATE:
+        case NT_ADD:
+        case NT_SUBTRACT:
+        case NT_MULTIPLY:
+        case NT_DIVIDE:
+        case NT_MODULO:
+        case NT_POWER:
+            break;
+        default:
+            hashable = false;
+            break;
+    }
+    if (!hashable)
+        return -1;
+
+    std::map<Key, int>::const_iterator ti = table.find(key);
+    int id;
+    if (ti == table.end()) {
+        id = table[key] = counts.size();
+        counts.push_back(0);
+        reads.push_back(std::set<unsigned int>());
+        params.push_back(std::set<unsigned int>());
+        if (key.type == NT_VARIABLE)
+            reads[id].insert(key.fn);
+        if (key.type == NT_PARAMETER)
+            params[id].insert(key.fn);
+        for (unsigned int i = 0; i < n; ++i) {
+            reads[id].insert(reads[key.children[i]].begin(), reads[key.children[i]].end());
+            params[id].insert(params[key.children[i]].begin(), params[key.children[i]].end());
+        }
+    } else {
+        id = ti->second;
+    }
+    ++counts[id];
+    ids[node] = id;
+    return id;
+}
+
+void YxlangCSE::kill(unsigned int slot, const std::vector<std::set<unsigned int> > &read, available_type &available) {
+    for (available_type::iterator ai = available.begin(); ai != available.end(); ) {
+        if (read[ai->first].count(slot))
+            available.erase(ai++);
+        else
+            ++ai;
+    }
+}
+
+void YxlangCSE::share(YxlangNode** slot, available_type &available) {
+    YxlangNode* node = *slot;
+    if (!node)
+        return;
+
+    std::map<const YxlangNode*, int>::const_iterator ii = ids.find(node);
+    int id = ii == ids.end() ? -1 : ii->second;
+    bool candidate = id >= 0 && counts[id] > 1 && node->type() != NT_CONSTANT && node->type() != NT_VARIABLE && node->type() != NT_PARAMETER;
+    if (candidate) {
+        available_type::const_iterator ai = available.find(id);
+        if (ai != available.end()) {
+            *slot = new (arena) CNShareRef(ai->second);
+            ++refs[ai->second];
+            return;
+        }
+    }
+
+    YxlangNode::Children slots(node);
+    unsigned int n = slots.size();
+    switch (node->type()) {
+        case NT_CONDITION: {
+            CNCondition* condition = static_cast<CNCondition*>(node);
+            share(&condition->cond, available);
+            available_type left = available;
+            available_type right = available;
+            share(&condition->left, left);
+            share(&condition->right, right);
+            /* only what neither branch killed is still there */
+            for (available_type::iterator ai = available.begin(); ai != available.end(); ) {
+                if (left.count(ai->first) && right.count(ai->first))
+                    ++ai;
+                else
+                    available.erase(ai++);
+            }
+            break;
+        }
+        case NT_CUSTOMFUNCTION: {
+            /* the body runs when called, not here */
+            available_type body;
+            share(&static_cast<CNCustomFunction*>(node)->right, body);
+            break;
+        }
+        default:
+            for (unsigned int i = 0; i < n; ++i)
+                share(slots.slot(i), available);
+            break;
+    }
+
+    if (node->type() == NT_ASSIGNMENT)
+        kill(static_cast<CNAssignment*>(node)->slot, reads, available);
+    else if (node->type() == NT_PARAMASSIGN)
+        kill(static_cast<CNParameterAssignment*>(node)->index, params, available);
+    else if (node->type() == NT_CALLUDF)
+        available.clear();
+
+    if (candidate) {
+        CNShare* shared = new (arena) CNShare(node);
+        *slot = shared;
+        available[id] = shared;
+    }
+}
+
+void YxlangCSE::cleanup(YxlangNode** slot, int &nextid) {
+    YxlangNode* node = *slot;
+    if (!node)
+        return;
+
+    YxlangNode::Children slots(node);
+    unsigned int n = slots.size();
+    for (unsigned int i = 0; i < n; ++i)
+        cleanup(slots.slot(i), nextid);
+
+    if (node->type() == NT_SHARE) {
+        CNShare* shared = static_cast<CNShare*>(node);
+        if (refs[shared] == 0) {
+            /* never read again, evaluate it in place */
+            *slot = shared->node;
+        } else {
+            shared->id = nextid++;
+        }
+    }
+}
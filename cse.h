@@ -0,0 +1,64 @@
+/**
+ * @file cse.h
+ * @brief common subexpression elimination over hash-consed subtrees
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#ifndef CSE_H
+#define CSE_H
+
+#include <vector>
+#include <map>
+#include <set>
+#include "expression.h"
+
+/** Finds structurally identical pure subtrees by hash-consing them, then
+ * walks the tree in evaluation order. The first occurrence of a repeated
+ * subtree becomes a CNShare, and each later occurrence that is sure to see
+ * the same value becomes a CNShareRef. An assignment stops sharing of the
+ * subtrees reading its variable or parameter, a UDF call stops all sharing, and values
+ * computed inside one branch of an if are not used after it. print and
+ * assignments are never merged. Run it after YxlangOptimizer. */
+class YxlangCSE {
+public:
+    explicit YxlangCSE(YxlangArena &_arena) : arena(_arena) {
+    }
+
+    /** returns the node to use instead of node, new nodes come from arena */
+    YxlangNode*	eliminate(YxlangNode* node);
+
+private:
+    /** structure of a node, children given by their ids */
+    struct Key {
+        int	type;
+        /// fn code, or the slot of a variable
+        int	fn;
+        /// bits of a constant, so -0 and 0 differ and NaN matches itself
+        unsigned long long	bits;
+        int	children[3];
+
+        bool operator<(const Key &other) const;
+    };
+    typedef std::map<int, CNShare*>	available_type;
+
+    int	hashcons(const YxlangNode* node);
+    void	share(YxlangNode** slot, available_type &available);
+    /** drop the available subtrees that read slot according to read */
+    void	kill(unsigned int slot, const std::vector<std::set<unsigned int> > &read, available_type &available);
+    void	cleanup(YxlangNode** slot, int &nextid);
+
+    YxlangArena&	arena;
+    std::map<Key, int>	table;
+    std::map<const YxlangNode*, int>	ids;
+    /// occurrences of each id
+    std::vector<unsigned int>	counts;
+    /// variables read by each id
+    std::vector<std::set<unsigned int> >	reads;
+    /// parameters read by each id, inside a function body
+    std::vector<std::set<unsigned int> >	params;
+    /// references to each share
+    std::map<const CNShare*, unsigned int>	refs;
+};
+
+#endif // CSE_H
@@ -5,37 +5,176 @@
  * @date 2023-10-26
  */
 
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <fstream>
-#include <sstream>
 #include "driver.h"
 #include "scanner.h"
+#include "expression.h"
+#include "optimizer.h"
+#include "cse.h"
+#include "parsecache.h"
 
 namespace yxlang {
 
-Driver::Driver(class YxlangContext& _calc) : trace_scanning(false), trace_parsing(false), calc(_calc) {
+Driver::Driver(class YxlangContext& _calc) : trace_scanning(false), trace_parsing(false), optimize_level(OPTIMIZE_NONE), streaming(false), calc(_calc), cache(NULL) {
+    lexer = new Scanner(calc);
+    parser = new Parser(*this);
+}
+
+Driver::~Driver() {
+    delete parser;
+    delete lexer;
+    delete cache;
+}
+
+void Driver::setCache(size_t capacity) {
+    if (cache)
+        cache->resize(capacity);
+    else if (capacity)
+        cache = new YxlangParseCache(capacity);
 }
 
 bool Driver::parse_stream(std::istream& in, const std::string& sname) {
+    lexer->scan_stream(&in);
+    return parse(sname);
+}
+
+bool Driver::parse_buffer(char* base, size_t size, const std::string& sname) {
+    if (!lexer->scan_buffer(base, size)) {
+        error(sname + ": input too large or not terminated by two NUL bytes");
+        return false;
+    }
+    return parse(sname);
+}
+
+bool Driver::parse(const std::string& sname) {
     streamname = sname;
+    lexer->set_debug(trace_scanning);
+    lexer->set_eager(streaming);
+
+    size_t first = calc.expressions.size();
+    parser->set_debug_level(trace_parsing);
+    /* streamed statements get an arena of their own, so releasing it
+     * after each one leaves the expressions already there alone */
+    YxlangArena* own = streaming ? calc.swapArena(new YxlangArena()) : NULL;
+    int status = parser->parse();
+    if (streaming) {
+        YxlangArena* arena = calc.swapArena(own);
+        if (arena->isPinned())
+            calc.retain(arena);
+        else
+            delete arena;
+    }
+    if (status != 0)
+        return false;
+
+    if (!streaming)
+        optimize(first);
+    return true;
+}
 
-    Scanner scanner(&in);
-    scanner.set_debug(trace_scanning);
-    this->lexer = &scanner;
+void Driver::optimize(size_t first) {
+    if (optimize_level == OPTIMIZE_NONE)
+        return;
 
-    Parser parser(*this);
-    parser.set_debug_level(trace_parsing);
-    return (parser.parse() == 0);
+    YxlangOptimizer optimizer(calc, static_cast<YxlangOptimizeLevel>(optimize_level));
+    for (size_t i = first; i < calc.expressions.size(); ++i) {
+        calc.expressions[i] = optimizer.optimize(calc.expressions[i]);
+    }
+    YxlangCSE cse(calc.getArena());
+    for (size_t i = first; i < calc.expressions.size(); ++i) {
+        calc.expressions[i] = cse.eliminate(calc.expressions[i]);
+    }
+}
+
+YxlangNode* Driver::statement(YxlangNode* list, YxlangNode* stmt) {
+    if (streaming) {
+        /* the parser holds no node between statements, so the arena can go */
+        size_t index = calc.expressions.size();
+        calc.expressions.push_back(stmt);
+        optimize(index);
+        double value = calc.evaluate(index);
+        if (executed)
+            executed(calc.expressions[index], value);
+        calc.popExpression();
+        return NULL;
+    }
+
+    return CNBlock::join(calc.getArena(), list, stmt);
 }
 
 bool Driver::parse_file(const std::string &filename) {
-    std::ifstream in(filename.c_str());
-    if (!in.good()) return false;
-    return parse_stream(in, filename);
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (streaming || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || static_cast<unsigned long long>(st.st_size) >= INT_MAX) {
+        /* pipes and the like cannot be mapped, flex counts in int, and a
+         * mapping would keep the pages of a streamed file once read */
+        close(fd);
+        std::ifstream in(filename.c_str());
+        if (!in.good()) return false;
+        return parse_stream(in, filename);
+    }
+
+    /* map the file into zeroed memory one page longer at least, so the two
+     * NUL bytes after it are there whatever its size. The mapping is
+     * private, the scanner writes are never seen by the file. */
+    size_t size = st.st_size;
+    size_t pagesize = sysconf(_SC_PAGESIZE);
+    size_t length = (size + 2 + pagesize - 1) / pagesize * pagesize;
+    void* base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    if (size && mmap(base, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, length);
+        close(fd);
+        return false;
+    }
+    close(fd);
+    madvise(base, size, MADV_SEQUENTIAL);
+
+    bool result = parse_buffer(static_cast<char*>(base), size, filename);
+    munmap(base, length);
+    return result;
 }
 
 bool Driver::parse_string(const std::string &input, const std::string& sname) {
-    std::istringstream iss(input);
-    return parse_stream(iss, sname);
+    if (!cache || !cache->capacity() || trace_scanning || trace_parsing || streaming)
+        return parse_copy(input, sname);
+    if (cache->find(calc, input, optimize_level))
+        return true;
+
+    /* parse into an arena of its own, for the cache to keep */
+    YxlangArena* arena = new YxlangArena(1024);
+    YxlangArena* own = calc.swapArena(arena);
+    size_t first = calc.expressions.size();
+    bool result = parse_copy(input, sname);
+    calc.swapArena(own);
+
+    if (!result) {
+        delete arena;
+    } else if (arena->isPinned()) {
+        calc.retain(arena, first);
+    } else {
+        cache->insert(calc, input, optimize_level, arena, first);
+    }
+    return result;
+}
+
+bool Driver::parse_copy(const std::string &input, const std::string& sname) {
+    buffer.resize(input.size() + 2);
+    memcpy(buffer.data(), input.data(), input.size());
+    buffer[input.size()] = 0;
+    buffer[input.size() + 1] = 0;
+    return parse_buffer(buffer.data(), input.size(), sname);
 }
 
 void Driver::error(const class location& l, const std::string& m) {
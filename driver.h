@@ -8,10 +8,14 @@
 #ifndef YXLANG_DRIVER_H
 #define YXLANG_DRIVER_H
 
+#include <stddef.h>
 #include <string>
 #include <vector>
+#include <functional>
 
 class YxlangContext;
+class YxlangParseCache;
+class YxlangNode;
 
 namespace yxlang {
 
@@ -19,20 +23,68 @@ class Driver {
 public:
     // Yxlang context
     Driver(class YxlangContext& calc);
+    ~Driver();
 
     bool trace_scanning;
     bool trace_parsing;
+    /// YxlangOptimizeLevel applied to every parsed expression
+    int optimize_level;
     std::string streamname;
+    /** run each top level statement as soon as it is parsed, then drop
+     * it again, so memory does not grow with the input. The expressions
+     * already in the context are left alone. Statements before a syntax
+     * error have run. */
+    bool streaming;
+    /// in streaming mode, called with each statement and its value
+    std::function<void (const YxlangNode*, double)> executed;
 
     bool parse_stream(std::istream& in, const std::string& sname = "stream input");
+    /** parse input from a copy in a buffer the driver keeps */
     bool parse_string(const std::string& input, const std::string& sname = "string stream");
+    /** parse a regular file straight from a private mapping of it, other
+     * files through a stream */
     bool parse_file(const std::string& filename);
+    /** parse size bytes at base in place, base[size] and base[size + 1]
+     * have to be 0, see Scanner::scan_buffer() */
+    bool parse_buffer(char* base, size_t size, const std::string& sname = "buffer input");
+
+    /** keep the expressions parsed by parse_string() for the last capacity
+     * texts, a repeated text is neither scanned nor parsed again, 0 turns
+     * the cache off. Not used while tracing or streaming. The driver has
+     * to outlive the expressions parsed through it. */
+    void setCache(size_t capacity);
+    /** the cache with its hit and miss counters, NULL if never turned on */
+    const YxlangParseCache* getCache() const {
+        return cache;
+    }
+
+    /** called by the parser with each top level statement, returns the
+     * statements so far with stmt appended, see CNBlock::join(), or NULL
+     * after running stmt when streaming */
+    YxlangNode* statement(YxlangNode* list, YxlangNode* stmt);
 
     void error(const class location& l, const std::string& m);
     void error(const std::string& m);
 
+    /// scanner and parser are kept for all parses, each gets new input
     class Scanner* lexer;
+    class Parser* parser;
     class YxlangContext& calc;
+
+private:
+    Driver(const Driver &);
+    Driver& operator=(const Driver &);
+
+    /** parse what the scanner has been given */
+    bool parse(const std::string& sname);
+    /** copy input to buffer and parse it there */
+    bool parse_copy(const std::string& input, const std::string& sname);
+    /** optimize calc.expressions from first on */
+    void optimize(size_t first);
+
+    YxlangParseCache* cache;
+    /// input of parse_string() with the two NUL bytes the scanner needs
+    std::vector<char> buffer;
 };
 
 } // namespace yxlang
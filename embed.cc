@@ -0,0 +1,124 @@
+/**
+ * @file embed.cc
+ * @brief compile once, evaluate many times from C++
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include "embed.h"
+
+namespace {
+
+/** true if evaluating node may run the body of a function */
+bool calls(const YxlangNode* node) {
+    if (!node)
+        return false;
+    if (node->type() == NT_CALLUDF || node->type() == NT_GUARD)
+        return true;
+
+    YxlangNode::Children children(node);
+    unsigned int n = children.size();
+    for (unsigned int i = 0; i < n; ++i) {
+        if (calls(children[i]))
+            return true;
+    }
+    return false;
+}
+
+} // namespace
+
+namespace yxlang {
+
+Program::State::~State() {
+    delete program;
+    if (arena && arena->isPinned())
+        calc->retain(arena);
+    else
+        delete arena;
+}
+
+void Program::State::link() {
+    delete program;
+    program = ClosureCompiler::compile(*calc, node, &bound);
+}
+
+double Program::State::call() {
+    /* function bodies read the variables through the context */
+    const std::vector<double*>* old = calc->variables.bind(&table);
+    double v = program->root();
+    calc->variables.bind(old);
+    return v;
+}
+
+void Compiler::bind(const std::string &name, double* p) {
+    unsigned int slot = calc.getSlot(name);
+    if (p)
+        bound[slot] = p;
+    else
+        bound.erase(slot);
+    relink();
+}
+
+void Compiler::relink() {
+    /* the closures point into the variable array */
+    if (base == calc.variables.data())
+        return;
+    base = calc.variables.data();
+    size_t kept = 0;
+    for (size_t i = 0; i < programs.size(); ++i) {
+        std::shared_ptr<Program::State> state = programs[i].lock();
+        if (!state)
+            continue;
+        state->link();
+        programs[kept++] = programs[i];
+    }
+    programs.resize(kept);
+}
+
+Program Compiler::compile(const std::string &source) {
+    /* parse into an arena of its own, which goes with the program, a
+     * function defined in it is left to the context then */
+    std::vector<char> text(source.begin(), source.end());
+    text.push_back(0);
+    text.push_back(0);
+    YxlangArena* arena = new YxlangArena(1024);
+    YxlangArena* own = calc.swapArena(arena);
+    size_t first = calc.expressions.size();
+    bool result = driver.parse_buffer(&text[0], source.size(), "source");
+    calc.swapArena(own);
+    /* the parse may have moved the variable array under the programs */
+    relink();
+
+    Program program;
+    if (!result) {
+        delete arena;
+        return program;
+    }
+
+    std::shared_ptr<Program::State> state(new Program::State());
+    state->calc = &calc;
+    state->node = first < calc.expressions.size() ? calc.expressions[first] : NULL;
+    calc.expressions.resize(first);
+    state->arena = arena;
+    state->bound = bound;
+    if (!bound.empty())
+        state->table.resize(bound.rbegin()->first + 1, NULL);
+    for (std::map<unsigned int, double*>::const_iterator bi = bound.begin(); bi != bound.end(); ++bi)
+        state->table[bi->first] = bi->second;
+    state->calls = calls(state->node);
+    state->link();
+    if (programs.size() == programs.capacity()) {
+        size_t kept = 0;
+        for (size_t i = 0; i < programs.size(); ++i) {
+            if (!programs[i].expired())
+                programs[kept++] = programs[i];
+        }
+        programs.resize(kept);
+    }
+    programs.push_back(state);
+
+    program.state = state;
+    return program;
+}
+
+} // namespace yxlang
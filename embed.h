@@ -0,0 +1,141 @@
+/**
+ * @file embed.h
+ * @brief compile once, evaluate many times from C++
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#ifndef YXLANG_EMBED_H
+#define YXLANG_EMBED_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include "expression.h"
+#include "closure.h"
+#include "driver.h"
+
+namespace yxlang {
+
+/** A compiled source, from Compiler::compile(). The handle is cheap to
+ * copy and copies share the compiled code. eval() runs the closures the
+ * source was compiled to. A default constructed or failed program is not
+ * valid and evaluates to 0. A program must not outlive its compiler.
+ *
+ * Bound variables are read and assigned at their host addresses with no
+ * lookup or copy. The bodies of the functions a program calls see its
+ * bindings too, through its table of them, which the context uses while
+ * the program runs. The unbound variables live in the array of the
+ * context, when a compile() or bind() moves it the compiler links its
+ * programs to the new one.
+ *
+ * eval() leaves the compiled code alone. It writes the variables the
+ * source assigns, the latest values of its common subexpressions and what
+ * its inlined calls found about their functions, which belong to this
+ * program and its copies, and the records of the functions it calls in
+ * the context. So a program and its copies run on one thread at a time,
+ * and different programs of a compiler only run on different threads at
+ * once if they call no function and assign no unbound variable. */
+class Program {
+public:
+    Program() {
+    }
+
+    bool valid() const {
+        return state != NULL;
+    }
+
+    /** value of the last top level statement of the source, not safe to
+     * call from two threads at once, see above */
+    double eval() const {
+        if (!state)
+            return 0;
+        if (!state->calls)
+            return state->program->root();
+        return state->call();
+    }
+
+private:
+    friend class Compiler;
+
+    struct State {
+        YxlangContext*	calc;
+        const YxlangNode*	node;
+        /// the arena of the nodes, the context takes it over when the
+        /// program goes if it holds a function definition
+        YxlangArena*	arena;
+        /// the bindings when compiled, slot to host address
+        std::map<unsigned int, double*>	bound;
+        /// the same by slot, NULL for unbound slots, the context reads
+        /// and assigns through it while a program calling functions runs
+        std::vector<double*>	table;
+        /// true if running the program may run the body of a function
+        bool	calls;
+        ClosureProgram*	program;
+
+        State() : calc(NULL), node(NULL), arena(NULL), calls(false), program(NULL) {
+        }
+        ~State();
+
+        /** compile the closures against the current variable array */
+        void	link();
+        /** run with the bindings in the context */
+        double	call();
+    };
+
+    std::shared_ptr<State>	state;
+};
+
+/** Compiles sources into programs sharing one context, for embedding the
+ * language in a C++ program:
+ *
+ *     yxlang::Compiler compiler;
+ *     double x, y;
+ *     compiler.bind("x", &x);
+ *     compiler.bind("y", &y);
+ *     yxlang::Program p = compiler.compile("sqrt(x*x + y*y)");
+ *     for (...) { x = ...; y = ...; r = p.eval(); }
+ *
+ * A function is defined when the program holding its definition is
+ * evaluated, from then on all programs of the compiler see it. They share
+ * the variables that are not bound. Programs are compiled to
+ * closures whatever the engine of the context. One compiler and its
+ * programs are used by one thread at a time. */
+class Compiler {
+public:
+    /// the context programs run in, with the functions they define
+    YxlangContext	calc;
+    /// parses the sources, set driver.optimize_level before compiling
+    Driver	driver;
+
+    Compiler() : driver(calc), base(NULL) {
+    }
+
+    /** read and assign the variable name at p in the programs compiled
+     * from now on, NULL unbinds it. p has to stay valid as long as they
+     * are used. */
+    void	bind(const std::string &name, double* p);
+
+    /** parse, optimize at driver.optimize_level and compile source,
+     * returns a program that is not valid on a syntax error */
+    Program	compile(const std::string &source);
+
+private:
+    Compiler(const Compiler &);
+    Compiler& operator=(const Compiler &);
+
+    /** link the programs still in use again if the variable array moved */
+    void	relink();
+
+    /// host address of each bound slot
+    std::map<unsigned int, double*>	bound;
+    /// programs compiled so far, some may be gone
+    std::vector<std::weak_ptr<Program::State> >	programs;
+    /// variable array the programs are linked against
+    const double*	base;
+};
+
+} // namespace yxlang
+
+#endif // YXLANG_EMBED_H
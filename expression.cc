@@ -12,9 +12,407 @@
 #include <vector>
 #include <ostream>
 #include <stdexcept>
+#include <algorithm>
 #include <cmath>
 #include "expression.h"
+#include "bytecode.h"
+#include "regvm.h"
+#include "jit.h"
+#include "closure.h"
+#include "flat.h"
+#include "batch.h"
+#include "threadpool.h"
+#include "memo.h"
+#include "reactive.h"
 
-YxlangNode::variablemap_type YxlangNode::variables;
+YxlangNode::Children::Children(const YxlangNode* _node) : items(NULL), count(0) {
+    YxlangNode* node = const_cast<YxlangNode*>(_node);
+    switch (node->type()) {
+        case NT_CONSTANT:
+        case NT_VARIABLE:
+            count = 0;
+            break;
+        case NT_NEGATE:
+            slots[0] = &static_cast<CNNegate*>(node)->node;
+            count = 1;
+            break;
+        case NT_ADD:
+            slots[0] = &static_cast<CNAdd*>(node)->left;
+            slots[1] = &static_cast<CNAdd*>(node)->right;
+            count = 2;
+            break;
+        case NT_SUBTRACT:
+            slots[0] = &static_cast<CNSubtract*>(node)->left;
+            slots[1] = &static_cast<CNSubtract*>(node)->right;
+            count = 2;
+            break;
+        case NT_MULTIPLY:
+            slots[0] = &static_cast<CNMultiply*>(node)->left;
+            slots[1] = &static_cast<CNMultiply*>(node)->right;
+            count = 2;
+            break;
+        case NT_DIVIDE:
+            slots[0] = &static_cast<CNDivide*>(node)->left;
+            slots[1] = &static_cast<CNDivide*>(node)->right;
+            count = 2;
+            break;
+        case NT_MODULO:
+            slots[0] = &static_cast<CNModulo*>(node)->left;
+            slots[1] = &static_cast<CNModulo*>(node)->right;
+            count = 2;
+            break;
+        case NT_POWER:
+            slots[0] = &static_cast<CNPower*>(node)->left;
+            slots[1] = &static_cast<CNPower*>(node)->right;
+            count = 2;
+            break;
+        case NT_COMPARE:
+            slots[0] = &static_cast<CNCompare*>(node)->left;
+            slots[1] = &static_cast<CNCompare*>(node)->right;
+            count = 2;
+            break;
+        case NT_UNARYFUNCTION:
+            slots[0] = &static_cast<CNUnaryFunction*>(node)->left;
+            count = 1;
+            break;
+        case NT_BINARYFUNCTION:
+            slots[0] = &static_cast<CNBinaryFunction*>(node)->left;
+            slots[1] = &static_cast<CNBinaryFunction*>(node)->right;
+            count = 2;
+            break;
+        case NT_EXPRLIST:
+            slots[0] = &static_cast<CNExprlist*>(node)->left;
+            slots[1] = &static_cast<CNExprlist*>(node)->right;
+            count = 2;
+            break;
+        case NT_ASSIGNMENT:
+            slots[0] = &static_cast<CNAssignment*>(node)->left;
+            count = 1;
+            break;
+        case NT_CONDITION:
+            slots[0] = &static_cast<CNCondition*>(node)->cond;
+            slots[1] = &static_cast<CNCondition*>(node)->left;
+            slots[2] = &static_cast<CNCondition*>(node)->right;
+            count = 3;
+            break;
+        case NT_BLOCK:
+            items = static_cast<CNBlock*>(node)->statements;
+            count = static_cast<CNBlock*>(node)->count;
+            break;
+        case NT_PARAMLIST:
+            slots[0] = &static_cast<CNParamlist*>(node)->left;
+            slots[1] = &static_cast<CNParamlist*>(node)->right;
+            count = 2;
+            break;
+        case NT_CUSTOMFUNCTION:
+            slots[0] = &static_cast<CNCustomFunction*>(node)->left;
+            slots[1] = &static_cast<CNCustomFunction*>(node)->right;
+            count = 2;
+            break;
+        case NT_CALLUDF:
+            slots[0] = &static_cast<CNCallUDF*>(node)->left;
+            slots[1] = &static_cast<CNCallUDF*>(node)->right;
+            count = 2;
+            break;
+        case NT_SHARE:
+            slots[0] = &static_cast<CNShare*>(node)->node;
+            count = 1;
+            break;
+        case NT_SHAREREF:
+        case NT_PARAMETER:
+        case NT_GUARD:
+            count = 0;
+            break;
+        case NT_PARAMASSIGN:
+            slots[0] = &static_cast<CNParameterAssignment*>(node)->left;
+            count = 1;
+            break;
+    }
+}
 
-YxlangNode::functionmap_type YxlangNode::functions;
+namespace {
+
+void resolveParameters(YxlangNode** slot, const std::map<unsigned int, unsigned int> &params, YxlangArena &arena) {
+    YxlangNode* node = *slot;
+    if (!node || node->type() == NT_CUSTOMFUNCTION)
+        return;
+
+    YxlangNode::Children children(node);
+    for (unsigned int i = 0; i < children.size(); ++i)
+        resolveParameters(children.slot(i), params, arena);
+
+    std::map<unsigned int, unsigned int>::const_iterator pi;
+    if (node->type() == NT_VARIABLE) {
+        const CNVariable* v = static_cast<const CNVariable*>(node);
+        if ((pi = params.find(v->symbol)) != params.end())
+            *slot = new (arena) CNParameter(v->symbol, pi->second);
+        else
+            *slot = new (arena) CNGlobalVariable(v->symbol);
+    } else if (node->type() == NT_ASSIGNMENT) {
+        const CNAssignment* a = static_cast<const CNAssignment*>(node);
+        if ((pi = params.find(a->symbol)) != params.end())
+            *slot = new (arena) CNParameterAssignment(a->symbol, pi->second, a->left);
+        else
+            *slot = new (arena) CNGlobalAssignment(a->symbol, a->left);
+    }
+}
+
+} // namespace
+
+CNVariable* CNVariable::copy(YxlangArena &arena) const {
+    return new (arena) CNVariable(symbol);
+}
+
+CNVariable* CNGlobalVariable::copy(YxlangArena &arena) const {
+    return new (arena) CNGlobalVariable(symbol);
+}
+
+void CNCustomFunction::resolve(YxlangArena &arena) {
+    std::map<unsigned int, unsigned int> params;
+    unsigned int index = 0;
+    for (const YxlangNode* p = left; p && p->type() == NT_PARAMLIST; p = static_cast<const CNParamlist*>(p)->left)
+        params[static_cast<const CNParamlist*>(p)->symbol] = index++;
+    resolveParameters(&right, params, arena);
+}
+
+double CNCustomFunction::call(YxlangContext &calc, size_t base) const {
+    YxlangMemo* memo = calc.getMemoize() ? calc.memo(this) : NULL;
+    if (!memo)
+        return run(calc, base);
+
+    double v;
+    if (memo->find(calc.frames.data() + base, v)) {
+        calc.top = base;
+        return v;
+    }
+    /* the body may assign its parameters or replace the record */
+    std::vector<double> args(calc.frames.begin() + base, calc.frames.begin() + base + nparams);
+    v = run(calc, base);
+    memo->insert(args.data(), v);
+    return v;
+}
+
+double CNCustomFunction::run(YxlangContext &calc, size_t base) const {
+    size_t caller = calc.frame;
+    calc.frame = base;
+    double v = 0;
+    const YxlangNode* node = right;
+    while (node) {
+        if (node->type() == NT_BLOCK) {
+            const CNBlock* n = static_cast<const CNBlock*>(node);
+            if (n->count == 0)
+                break;
+            for (unsigned int i = 0; i + 1 < n->count; ++i)
+                n->statements[i]->evaluate(calc);
+            node = n->statements[n->count - 1];
+        } else if (node->type() == NT_CONDITION) {
+            const CNCondition* n = static_cast<const CNCondition*>(node);
+            node = YxlangNode::truth(n->cond->evaluate(calc)) ? n->left : n->right;
+        } else if (node->type() == NT_CALLUDF) {
+            /* nothing is left to do in this body, the callee's record
+             * takes the place of this one */
+            size_t args = calc.top;
+            const CNCustomFunction* callee = static_cast<const CNCallUDF*>(node)->arguments(calc);
+            if (!callee)
+                break;
+            std::copy(calc.frames.begin() + args, calc.frames.begin() + calc.top, calc.frames.begin() + base);
+            calc.top = base + (calc.top - args);
+            node = callee->right;
+        } else {
+            v = node->evaluate(calc);
+            break;
+        }
+    }
+    calc.frame = caller;
+    calc.top = base;
+    return v;
+}
+
+YxlangContext::~YxlangContext() {
+    clearExpressions();
+    clearMemos();
+    delete reactive;
+    for (std::set<YxlangArena*>::iterator ai = retained.begin(); ai != retained.end(); ++ai) {
+        delete *ai;
+    }
+    delete arena;
+    delete pool;
+}
+
+double YxlangContext::compileAndEvaluate(unsigned int index) {
+    if (engine == ENGINE_TREE)
+        return expressions[index] ? expressions[index]->evaluate(*this) : 0;
+
+    /* the programs point into the variable array, a parse may have moved it */
+    if (base != variables.data()) {
+        clearPrograms();
+        base = variables.data();
+    }
+    if (programs.size() < expressions.size())
+        programs.resize(expressions.size(), NULL);
+    if (!programs[index])
+        programs[index] = compile(expressions[index]);
+    return programs[index]->run(*this);
+}
+
+void YxlangContext::clearPrograms() {
+    for(unsigned int i = 0; i < programs.size(); ++i) {
+        delete programs[i];
+    }
+    programs.clear();
+    for(unsigned int i = 0; i < batches.size(); ++i) {
+        delete batches[i];
+    }
+    batches.clear();
+}
+
+void YxlangContext::setFunction(unsigned int symbol, const CNCustomFunction* value) {
+    CNCustomFunction* &f = functions[symbol];
+    if (f != value) {
+        value->arena->hold();
+        if (f)
+            unhold(f->arena);
+        f = const_cast<CNCustomFunction*>(value);
+        ++definitions;
+        clearMemos();
+    }
+}
+
+void YxlangContext::popExpression() {
+    if (expressions.empty())
+        return;
+    size_t last = expressions.size() - 1;
+    if (programs.size() > last) {
+        delete programs[last];
+        programs.resize(last);
+    }
+    if (batches.size() > last) {
+        delete batches[last];
+        batches.resize(last);
+    }
+    expressions.pop_back();
+    invalidateReactive();
+    /* a replaced definition can only be reached through the expressions
+     * parsed with it, the guards and the parse cache know definitions by
+     * serial and never look at a freed one */
+    while (!parsed.empty() && parsed.back().first >= expressions.size()) {
+        unhold(parsed.back().second);
+        parsed.pop_back();
+    }
+
+    for (size_t i = 0; i < expressions.size(); ++i) {
+        if (arena->contains(expressions[i]))
+            return;
+    }
+    if (arena->isHeld()) {
+        retained.insert(arena);
+        arena = new YxlangArena();
+    } else {
+        arena->release();
+    }
+}
+
+void YxlangContext::evaluateBatch(unsigned int index, const std::map<std::string, const double*> &columns, size_t nrows, double* out) {
+    /* names the scanner never saw cannot occur in the expression */
+    BatchColumns bound;
+    for (std::map<std::string, const double*>::const_iterator ci = columns.begin(); ci != columns.end(); ++ci) {
+        unsigned int symbol;
+        if (symbols.find(ci->first, symbol))
+            bound[variables.slot(symbol)] = ci->second;
+    }
+
+    if (batches.size() < expressions.size())
+        batches.resize(expressions.size(), NULL);
+    if (!batches[index])
+        batches[index] = BatchCompiler::compile(expressions[index]);
+    const BatchProgram* program = batches[index];
+
+    unsigned int threads = getThreads();
+    if (threads < 2 || !program->threadsafe || nrows <= BatchProgram::MORSEL) {
+        program->run(*this, bound, 0, nrows, out);
+        return;
+    }
+    if (!pool || pool->size() != threads) {
+        delete pool;
+        pool = new YxlangThreadPool(threads);
+    }
+    /* every morsel writes its own part of out */
+    pool->run(nrows, BatchProgram::MORSEL, [&](size_t begin, size_t end) {
+        program->run(*this, bound, begin, end, out);
+    });
+}
+
+void YxlangContext::setMemoize(size_t capacity) {
+    if (memoize != capacity) {
+        clearMemos();
+        memoize = capacity;
+    }
+}
+
+YxlangMemo* YxlangContext::memo(const CNCustomFunction* func) {
+    memomap_type::iterator mi = memos.find(func->symbol);
+    if (mi != memos.end())
+        return mi->second;
+    if (getFunction(func->symbol) != func)
+        return NULL;
+    YxlangMemo* memo = YxlangMemo::pure(*this, func) ? new YxlangMemo(func->nparams, memoize) : NULL;
+    memos[func->symbol] = memo;
+    return memo;
+}
+
+void YxlangContext::clearMemos() {
+    for (memomap_type::iterator mi = memos.begin(); mi != memos.end(); ++mi) {
+        delete mi->second;
+    }
+    memos.clear();
+}
+
+void YxlangContext::setReactive(bool on) {
+    if (on && !reactive) {
+        reactive = new YxlangReactive();
+    } else if (!on) {
+        delete reactive;
+        reactive = NULL;
+    }
+}
+
+size_t YxlangContext::update(unsigned int slot, double value) {
+    if (!reactive) {
+        variables[slot] = value;
+        return 0;
+    }
+    return reactive->update(*this, slot, value);
+}
+
+void YxlangContext::invalidateReactive() {
+    if (reactive)
+        reactive->invalidate();
+}
+
+void YxlangContext::setThreads(unsigned int _nthreads) {
+    nthreads = _nthreads;
+}
+
+unsigned int YxlangContext::getThreads() const {
+    if (nthreads)
+        return nthreads;
+    unsigned int n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+YxlangProgram* YxlangContext::compile(const YxlangNode* node) {
+    switch (engine) {
+        case ENGINE_STACK:
+            return StackCompiler::compile(*this, node);
+        case ENGINE_REGISTER:
+            return RegisterCompiler::compile(*this, node);
+        case ENGINE_JIT:
+            return JitCompiler::compile(*this, node);
+        case ENGINE_CLOSURE:
+            return ClosureCompiler::compile(*this, node);
+        case ENGINE_FLAT:
+            return FlatCompiler::compile(node);
+        default:
+            return NULL;
+    }
+}
@@ -12,128 +12,586 @@
 #include <string.h>
 #include <iostream>
 #include <map>
+#include <set>
 #include <vector>
 #include <ostream>
 #include <stdexcept>
+#include <algorithm>
 #include <cmath>
+#include "arena.h"
+#include "vecmath.h"
 
+class YxlangNode;
 class CNCustomFunction;
+class YxlangProgram;
+class BatchProgram;
+class YxlangThreadPool;
+class YxlangMemo;
+class YxlangReactive;
+
+/** node types, lets the compilers lower the tree without dynamic_cast */
+enum YxlangNodeType {
+    NT_CONSTANT,
+    NT_VARIABLE,
+    NT_NEGATE,
+    NT_ADD,
+    NT_SUBTRACT,
+    NT_MULTIPLY,
+    NT_DIVIDE,
+    NT_MODULO,
+    NT_POWER,
+    NT_COMPARE,
+    NT_UNARYFUNCTION,
+    NT_BINARYFUNCTION,
+    NT_EXPRLIST,
+    NT_ASSIGNMENT,
+    NT_CONDITION,
+    NT_BLOCK,
+    NT_PARAMLIST,
+    NT_CUSTOMFUNCTION,
+    NT_CALLUDF,
+    NT_SHARE,
+    NT_SHAREREF,
+    NT_PARAMETER,
+    NT_PARAMASSIGN,
+    NT_GUARD
+};
 
-/** base Yxlang node */
-class YxlangNode {
+/** fn codes of CMP tokens, as set by the scanner */
+enum { CMP_GT = 1, CMP_LT = 2, CMP_NE = 3, CMP_EQ = 4, CMP_GE = 5, CMP_LE = 6 };
+/** fn codes of UNARYFUNC tokens */
+enum { UF_SQRT = 1, UF_EXP = 2, UF_LOG = 3, UF_PRINT = 4 };
+/** fn codes of BINARYFUNC tokens */
+enum { BF_POW = 1 };
+
+/** interned identifiers. The scanner turns every name into a small id,
+ * each name is stored once, and everything after the scanner compares
+ * and looks up ids. */
+class YxlangSymbols {
 public:
-    typedef std::map<std::string, double> variablemap_type;
-    static variablemap_type		variables;
-    typedef std::map<std::string, CNCustomFunction*> functionmap_type;
-    static functionmap_type		functions;
+    /** id of the name, added if there is none yet */
+    unsigned int intern(const std::string &name) {
+        symbolmap_type::const_iterator si = ids.find(name);
+        if (si != ids.end())
+            return si->second;
+        si = ids.insert(std::make_pair(name, static_cast<unsigned int>(names.size()))).first;
+        names.push_back(&si->first);
+        return si->second;
+    }
+    /** same for scanner text, no allocation once the name is known */
+    unsigned int intern(const char* text, size_t length) {
+        key.assign(text, length);
+        return intern(key);
+    }
+    /** id of the name, false if there is none */
+    bool find(const std::string &name, unsigned int &id) const {
+        symbolmap_type::const_iterator si = ids.find(name);
+        if (si == ids.end())
+            return false;
+        id = si->second;
+        return true;
+    }
+
+    const std::string& name(unsigned int id) const {
+        return *names[id];
+    }
+    unsigned int size() const {
+        return names.size();
+    }
+
+private:
+    typedef std::map<std::string, unsigned int> symbolmap_type;
+    symbolmap_type	ids;
+    /// the keys of ids, by id
+    std::vector<const std::string*>	names;
+    /// scratch buffer for scanner text
+    std::string	key;
+};
 
+/** variable storage, one flat array indexed by slots. The slot of a
+ * variable is its symbol id, the context adds a slot for every symbol it
+ * interns. New slots are added while parsing, which may move the array, so
+ * a pointer into it is only good until the next parse. A table of
+ * bindings can put some slots at other addresses for a while, for the
+ * readers going through bound(). */
+class YxlangVariables {
 public:
-    virtual ~YxlangNode() {
+    YxlangVariables() : bindings(NULL) {
     }
 
-    virtual double	evaluate() const = 0;
-
-    virtual void	print(std::ostream &os, unsigned int depth=0) const = 0;
-    static inline std::string indent(unsigned int d) {
-        return std::string(d * 2, ' ');
+    /** slot of the variable named by symbol, added with value 0 if needed */
+    unsigned int slot(unsigned int symbol) {
+        if (symbol >= values.size())
+            values.resize(symbol + 1, 0);
+        return symbol;
+    }
+    /** true if the variable named by symbol has a slot */
+    bool exists(unsigned int symbol) const {
+        return symbol < values.size();
     }
 
-    void setVariable(const std::string &varname, double value) const {
-        variables[varname] = value;
+    double& operator[](unsigned int slot) {
+        return values[slot];
     }
-    bool existsVariable(const std::string &varname) const {
-        return variables.find(varname) != variables.end();
+    double operator[](unsigned int slot) const {
+        return values[slot];
     }
-    double getVariable(const std::string &varname) const {
-        variablemap_type::const_iterator vi = variables.find(varname);
-        if (vi == variables.end())
-            return 0;
+    /** the variable at slot, at its address in the bindings if it has one */
+    double& bound(unsigned int slot) {
+        if (bindings && slot < bindings->size() && (*bindings)[slot])
+            return *(*bindings)[slot];
+        return values[slot];
+    }
+    /** let bound() find the slots with an address in _bindings there,
+     * NULL for none. Returns the table used before. The table is not
+     * copied and has to stay until it is replaced. */
+    const std::vector<double*>*	bind(const std::vector<double*>* _bindings) {
+        const std::vector<double*>* old = bindings;
+        bindings = _bindings;
+        return old;
+    }
+    /** number of slots */
+    size_t size() const {
+        return values.size();
+    }
+    double* data() {
+        return values.empty() ? NULL : &values[0];
+    }
+    const double* data() const {
+        return values.empty() ? NULL : &values[0];
+    }
+
+private:
+    std::vector<double>	values;
+    /// address of each slot that is bound, by slot, NULL for the others
+    const std::vector<double*>*	bindings;
+};
+
+/** execution engines the context can evaluate expressions with */
+enum YxlangEngine {
+    /// walk the tree through YxlangNode::evaluate(calc)
+    ENGINE_TREE,
+    /// compile to bytecode and run it on the stack VM
+    ENGINE_STACK,
+    /// compile to three-address code and run it on the threaded register VM
+    ENGINE_REGISTER,
+    /// compile arithmetic to native x86-64 code, interpret the rest
+    ENGINE_JIT,
+    /// compile every subtree into a closure specialized on its operands
+    ENGINE_CLOSURE,
+    /// lay the tree out as flat post-order arrays and scan them forward
+    ENGINE_FLAT
+};
+
+/** Yxlang context. It owns all state of the interpreter: the symbols, the
+ * variables, the function definitions, the parsed expressions and what
+ * the engines compiled from them. Nodes and programs get the context
+ * passed to every evaluation, so contexts share no mutable data and
+ * separate contexts can be used by separate threads at the same time. One
+ * context is used by one thread at a time. */
+class YxlangContext {
+public:
+    typedef std::map<unsigned int, CNCustomFunction*> functionmap_type;
+    typedef std::map<unsigned int, YxlangMemo*> memomap_type;
+
+    YxlangSymbols	symbols;
+    YxlangVariables	variables;
+    /// function definitions by symbol, registered when they are evaluated
+    functionmap_type	functions;
+
+    std::vector<YxlangNode*>	expressions;
+    /// programs compiled from expressions, filled lazily by evaluate()
+    std::vector<YxlangProgram*>	programs;
+    /// batch programs compiled from expressions, filled lazily by evaluateBatch()
+    std::vector<BatchProgram*>	batches;
+
+    /// activation records of the UDF calls in progress, each holds the
+    /// arguments of one call, the innermost call's record is on top
+    std::vector<double>	frames;
+    /// first slot of the innermost call's record
+    size_t	frame;
+    /// first free slot of frames
+    size_t	top;
+    /// bumped whenever a name gets a different function, lets the guards
+    /// of inlined calls skip the lookup while it stays the same
+    unsigned long	definitions;
+    /// serial number of the last function definition parsed
+    unsigned long	serials;
+    /// bumped by clearExpressions(), nodes handed out since the last bump
+    /// may still be in expressions
+    unsigned long	generation;
+
+    /// result caches by function symbol, made by the first call of the
+    /// function once setMemoize() is on, NULL for an impure function
+    memomap_type	memos;
+
+    YxlangContext() : frame(0), top(0), definitions(0), serials(0), generation(0), arena(new YxlangArena()), engine(ENGINE_TREE), base(NULL), nthreads(0), pool(NULL), math(NULL), memoize(0), reactive(NULL) {
+    }
+
+    ~YxlangContext();
+
+    /** drop all expressions. Their nodes are released with the arena in
+     * one step, unless it holds a function definition that is current,
+     * then it is kept until the name gets another definition. */
+    void clearExpressions() {
+        clearPrograms();
+        expressions.clear();
+        invalidateReactive();
+        ++generation;
+        if (arena->isHeld()) {
+            retained.insert(arena);
+            arena = new YxlangArena();
+        } else {
+            arena->release();
+        }
+        while (!parsed.empty()) {
+            unhold(parsed.back().second);
+            parsed.pop_back();
+        }
+    }
+
+    /** drop the last expression and what was compiled from it. The arena
+     * is released as by clearExpressions() if none of the other
+     * expressions lives in it. */
+    void	popExpression();
+
+    /** arena the nodes of the next parse are allocated from */
+    YxlangArena&	getArena() {
+        return *arena;
+    }
+    /** allocate the nodes of the next parses from _arena, which the
+     * caller owns, and return the arena used so far. Swap the old one
+     * back before clearExpressions(). */
+    YxlangArena*	swapArena(YxlangArena* _arena) {
+        YxlangArena* old = arena;
+        arena = _arena;
+        return old;
+    }
+    /** take over an arena, it is freed once neither a current function
+     * definition nor one of the expressions from first on lives in it */
+    void	retain(YxlangArena* _arena, size_t first = static_cast<size_t>(-1)) {
+        if (first < expressions.size()) {
+            _arena->hold();
+            parsed.push_back(std::make_pair(first, _arena));
+        }
+        if (_arena->isHeld())
+            retained.insert(_arena);
         else
-            return vi->second;
+            delete _arena;
+    }
+
+    void clearPrograms();
+
+    YxlangEngine getEngine() const {
+        return engine;
+    }
+    void setEngine(YxlangEngine _engine) {
+        if (engine != _engine) {
+            clearPrograms();
+            engine = _engine;
+        }
+    }
+
+    /** evaluate expressions[index] with the selected engine */
+    inline double evaluate(unsigned int index);
+
+    /** evaluate expressions[index] for nrows rows at once, writing the
+     * value of row r to out[r]. columns maps variable names to arrays of
+     * nrows values, the other variables keep their current value. Large
+     * batches run on getThreads() threads, unless the expression calls a
+     * UDF, defines one or prints. */
+    void	evaluateBatch(unsigned int index, const std::map<std::string, const double*> &columns, size_t nrows, double* out);
+
+    /** threads used by evaluateBatch(), 0 for one per hardware thread */
+    void	setThreads(unsigned int _nthreads);
+    unsigned int	getThreads() const;
+
+    /** column kernels of evaluateBatch(), those of the best level the CPU
+     * supports unless setVecMath() chose one */
+    const VecMath&	getVecMath() const {
+        return math ? *math : VecMath::current();
+    }
+    /** use the kernels of level in evaluateBatch(), or those of the best
+     * supported level below it */
+    void	setVecMath(VecMathLevel level) {
+        math = &VecMath::get(level);
+    }
+
+    /** cache the results of pure UDFs, at most capacity argument tuples
+     * per function, 0 turns caching off. See YxlangMemo::pure() for what
+     * makes a function pure. */
+    void	setMemoize(size_t capacity);
+    size_t getMemoize() const {
+        return memoize;
+    }
+    /** cache of the function named symbol, NULL if it has not been called
+     * since caching was turned on or since the last definition of any
+     * function, or if it is impure. Has the hit and miss counters. */
+    const YxlangMemo* getMemo(unsigned int symbol) const {
+        memomap_type::const_iterator mi = memos.find(symbol);
+        return mi == memos.end() ? NULL : mi->second;
+    }
+    /** cache for a call of func, made on its first call, NULL if func is
+     * impure or not the current definition of its name */
+    YxlangMemo*	memo(const CNCustomFunction* func);
+    /** drop all caches, a new definition may change what a function
+     * returns or whether it is pure */
+    void	clearMemos();
+
+    /** symbol of scanner text, with a variable slot for it */
+    unsigned int	intern(const char* text, size_t length) {
+        return variables.slot(symbols.intern(text, length));
     }
 
-    void setFunction(const std::string &funcname, const CNCustomFunction* value) const {
-        functions[funcname] = const_cast<CNCustomFunction*>(value);
+    /** slot of varname, added if needed, for reading and writing it
+     * through variables without a name lookup */
+    unsigned int	getSlot(const std::string &varname) {
+        return variables.slot(symbols.intern(varname));
+    }
+    bool existsVariable(const std::string &varname) const {
+        unsigned int symbol;
+        return symbols.find(varname, symbol) && variables.exists(symbol);
     }
-    bool existsFunction(const std::string &funcname) const {
-        return functions.find(funcname) != functions.end();
+    double	getVariable(const std::string &varname) const {
+        unsigned int symbol;
+        if (!symbols.find(varname, symbol) || !variables.exists(symbol))
+            return 0;
+        else
+            return variables[symbol];
     }
-    CNCustomFunction* getFunction(const std::string &funcname) const {
-        functionmap_type::const_iterator vi = functions.find(funcname);
+    /** in reactive mode also re-evaluates the statements depending on the
+     * variable, see setReactive() */
+    void	setVariable(const std::string &varname, double value) {
+        if (reactive)
+            update(getSlot(varname), value);
+        else
+            variables[getSlot(varname)] = value;
+    }
+
+    /** reactive mode, for expressions used like a spreadsheet. The top
+     * level statements of the expressions are kept in a dependency graph
+     * by the variables they read and assign, and setVariable() re-runs
+     * only the statements the change reaches, see YxlangReactive. Run the
+     * expressions once with evaluate() first. */
+    void	setReactive(bool on);
+    bool isReactive() const {
+        return reactive != NULL;
+    }
+    /** the dependency graph in reactive mode, NULL otherwise */
+    const YxlangReactive* getReactive() const {
+        return reactive;
+    }
+    /** set the variable in slot to value and re-evaluate the statements
+     * depending on it, returns how many were evaluated. Reactive mode
+     * only, otherwise it just sets the variable and returns 0. */
+    size_t	update(unsigned int slot, double value);
+
+    /** add v to the record being built on top of frames */
+    void push(double v) {
+        if (top == frames.size())
+            frames.resize(frames.size() * 2 + 64);
+        frames[top++] = v;
+    }
+
+    /** make value the definition of symbol, the arena of the one it
+     * replaces is freed once nothing else holds it */
+    void	setFunction(unsigned int symbol, const CNCustomFunction* value);
+    bool existsFunction(unsigned int symbol) const {
+        return functions.find(symbol) != functions.end();
+    }
+    CNCustomFunction* getFunction(unsigned int symbol) const {
+        functionmap_type::const_iterator vi = functions.find(symbol);
         if (vi == functions.end())
             return NULL;
         else
             return vi->second;
     }
+
+private:
+    YxlangContext(const YxlangContext &);
+    YxlangContext& operator=(const YxlangContext &);
+
+    YxlangProgram* compile(const YxlangNode* node);
+    /** evaluate() unless a program is ready, compiles one for any engine
+     * but the tree walker */
+    double	compileAndEvaluate(unsigned int index);
+
+    YxlangArena*	arena;
+    /// arenas of earlier parses that are still held
+    std::set<YxlangArena*>	retained;
+    /// retained arenas some of the expressions live in, each with the
+    /// index of the first of them, in the order they were retained
+    std::vector<std::pair<size_t, YxlangArena*> >	parsed;
+    YxlangEngine	engine;
+    /// variable array the programs were compiled against
+    const double*	base;
+    /// requested number of batch threads, 0 for all
+    unsigned int	nthreads;
+    /// created by the first batch that runs on several threads
+    YxlangThreadPool*	pool;
+    /// kernels chosen by setVecMath(), NULL for the best supported
+    const VecMath*	math;
+    /// capacity of each cache in memos, 0 for no caching
+    size_t	memoize;
+    /// dependency graph of the statements, NULL unless in reactive mode
+    YxlangReactive*	reactive;
+
+    void	invalidateReactive();
+    /** drop a hold of _arena, freeing it if it was retained and nothing
+     * holds it anymore */
+    void	unhold(YxlangArena* _arena) {
+        if (_arena->drop() && retained.erase(_arena))
+            delete _arena;
+    }
+};
+
+/** base Yxlang node */
+class YxlangNode {
+public:
+    virtual ~YxlangNode() {
+    }
+
+    /** nodes only live in an arena, as new (arena) CNxxx(...) */
+    static void* operator new(size_t size, YxlangArena &arena) {
+        return arena.allocate(size);
+    }
+    static void operator delete(void*, YxlangArena &) {
+    }
+    /** nodes are never deleted one by one, their destructors are not run
+     * and the memory goes with the arena */
+    static void operator delete(void*) {
+    }
+
+    /** value of the node. All state it reads or writes, variables and
+     * function definitions, belongs to calc. */
+    virtual double	evaluate(YxlangContext &calc) const = 0;
+
+    virtual YxlangNodeType	type() const = 0;
+
+    /** truth value of a condition, the tree walker and all engines agree on it */
+    static inline bool truth(double v) {
+        return static_cast<int>(v) != 0;
+    }
+
+    /** the addresses of the child pointers of a node, in evaluation order,
+     * so passes can walk and rewrite any kind of node. Slots may hold NULL
+     * children. A block has as many as it has statements. */
+    class Children {
+    public:
+        explicit Children(const YxlangNode* node);
+
+        unsigned int size() const {
+            return count;
+        }
+        YxlangNode** slot(unsigned int i) const {
+            return items ? items + i : slots[i];
+        }
+        YxlangNode* operator[](unsigned int i) const {
+            return *slot(i);
+        }
+
+    private:
+        YxlangNode**	slots[3];
+        /// the statements of a block
+        YxlangNode**	items;
+        unsigned int	count;
+    };
+
+    virtual void	print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth=0) const = 0;
+    static inline std::string indent(unsigned int d) {
+        return std::string(d * 2, ' ');
+    }
 };
 
 /** constant Yxlang node  */
 class CNConstant : public YxlangNode {
+public:
     double	value;
     
 public:
     explicit CNConstant(double _value) : YxlangNode(), value(_value) {
     }
 
-    virtual double evaluate() const {
+    virtual double evaluate(YxlangContext &) const {
         return value;
     }
 
-    virtual void print(std::ostream &os, unsigned int depth) const {
+    virtual YxlangNodeType type() const {
+        return NT_CONSTANT;
+    }
+
+    virtual void print(std::ostream &os, const YxlangSymbols &, unsigned int depth) const {
         os << indent(depth) << value << std::endl;
     }
 };
 
 /** variable Yxlang node  */
 class CNVariable : public YxlangNode {
+public:
     double	value;
-    std::string* name;
+    unsigned int	symbol;
+    unsigned int	slot;
 
 public:
-    explicit CNVariable(std::string* _name) : YxlangNode(), name(_name) {
+    explicit CNVariable(unsigned int _symbol) : YxlangNode(), value(0), symbol(_symbol), slot(_symbol) {
     }
 
-    virtual ~CNVariable() {
-        delete name;
+    virtual double evaluate(YxlangContext &calc) const {
+        return calc.variables[slot];
     }
 
-    virtual double evaluate() const {
-        double v = 0;
-        if (existsVariable(*name)) {
-            v = getVariable(*name);
-        }
-        return v;
+    virtual YxlangNodeType type() const {
+        return NT_VARIABLE;
     }
 
-    virtual void print(std::ostream &os, unsigned int depth) const {
-        os << indent(depth) << *name << ":" << value << std::endl;
+    /** a new node reading the same variable the same way */
+    virtual CNVariable* copy(YxlangArena &arena) const;
+
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
+        os << indent(depth) << symbols.name(symbol) << ":" << value << std::endl;
     }
 };
 
+/** variable read in the body of a function, sees the bindings of the
+ * embedded program calling it, see YxlangVariables::bind */
+class CNGlobalVariable : public CNVariable {
+public:
+    explicit CNGlobalVariable(unsigned int _symbol) : CNVariable(_symbol) {
+    }
+
+    virtual double evaluate(YxlangContext &calc) const {
+        return calc.variables.bound(slot);
+    }
+
+    virtual CNVariable* copy(YxlangArena &arena) const;
+};
+
 /** negate Yxlang node  */
 class CNNegate : public YxlangNode {
+public:
     YxlangNode* 	node;
 
 public:
     explicit CNNegate(YxlangNode* _node) : YxlangNode(), node(_node) {
     }
 
-    virtual ~CNNegate() {
-        delete node;
+    virtual double evaluate(YxlangContext &calc) const {
+        return - node->evaluate(calc);
     }
 
-    virtual double evaluate() const {
-        return - node->evaluate();
+    virtual YxlangNodeType type() const {
+        return NT_NEGATE;
     }
 
-    virtual void print(std::ostream &os, unsigned int depth) const {
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
         os << indent(depth) << "- negate" << std::endl;
-        node->print(os, depth+1);
+        node->print(os, symbols, depth+1);
     }
 };
 
 /** add Yxlang node */
 class CNAdd : public YxlangNode {
+public:
     YxlangNode* 	left;
     YxlangNode* 	right;
     
@@ -141,24 +599,25 @@ public:
     explicit CNAdd(YxlangNode* _left, YxlangNode* _right) : YxlangNode(), left(_left), right(_right) {
     }
 
-    virtual ~CNAdd() {
-        delete left;
-        delete right;
+    virtual double evaluate(YxlangContext &calc) const {
+        double leftValue = left->evaluate(calc);
+        return leftValue + right->evaluate(calc);
     }
 
-    virtual double evaluate() const {
-        return left->evaluate() + right->evaluate();
+    virtual YxlangNodeType type() const {
+        return NT_ADD;
     }
 
-    virtual void print(std::ostream &os, unsigned int depth) const {
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
         os << indent(depth) << "+ add" << std::endl;
-        left->print(os, depth+1);
-        right->print(os, depth+1);
+        left->print(os, symbols, depth+1);
+        right->print(os, symbols, depth+1);
     }
 };
 
 /** subtract Yxlang node */
 class CNSubtract : public YxlangNode {
+public:
     YxlangNode* 	left;
     YxlangNode* 	right;
     
@@ -166,24 +625,25 @@ public:
     explicit CNSubtract(YxlangNode* _left, YxlangNode* _right) : YxlangNode(), left(_left), right(_right) {
     }
 
-    virtual ~CNSubtract() {
-        delete left;
-        delete right;
+    virtual double evaluate(YxlangContext &calc) const {
+        double leftValue = left->evaluate(calc);
+        return leftValue - right->evaluate(calc);
     }
 
-    virtual double evaluate() const {
-        return left->evaluate() - right->evaluate();
+    virtual YxlangNodeType type() const {
+        return NT_SUBTRACT;
     }
 
-    virtual void print(std::ostream &os, unsigned int depth) const {
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
         os << indent(depth) << "- subtract" << std::endl;
-        left->print(os, depth+1);
-        right->print(os, depth+1);
+        left->print(os, symbols, depth+1);
+        right->print(os, symbols, depth+1);
     }
 };
 
 /** multiply Yxlang node */
 class CNMultiply : public YxlangNode {
+public:
     YxlangNode* 	left;
     YxlangNode* 	right;
     
@@ -191,24 +651,25 @@ public:
     explicit CNMultiply(YxlangNode* _left, YxlangNode* _right) : YxlangNode(), left(_left), right(_right) {
     }
 
-    virtual ~CNMultiply() {
-        delete left;
-        delete right;
+    virtual double evaluate(YxlangContext &calc) const {
+        double leftValue = left->evaluate(calc);
+        return leftValue * right->evaluate(calc);
     }
 
-    virtual double evaluate() const {
-        return left->evaluate() * right->evaluate();
+    virtual YxlangNodeType type() const {
+        return NT_MULTIPLY;
     }
 
-    virtual void print(std::ostream &os, unsigned int depth) const {
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
         os << indent(depth) << "* multiply" << std::endl;
-        left->print(os, depth+1);
-        right->print(os, depth+1);
+        left->print(os, symbols, depth+1);
+        right->print(os, symbols, depth+1);
     }
 };
 
 /** divide Yxlang node */
 class CNDivide : public YxlangNode {
+public:
     YxlangNode* 	left;
     YxlangNode* 	right;
     
@@ -216,24 +677,25 @@ public:
     explicit CNDivide(YxlangNode* _left, YxlangNode* _right) : YxlangNode(), left(_left), right(_right) {
     }
 
-    virtual ~CNDivide() {
-        delete left;
-        delete right;
+    virtual double evaluate(YxlangContext &calc) const {
+        double leftValue = left->evaluate(calc);
+        return leftValue / right->evaluate(calc);
     }
 
-    virtual double evaluate() const {
-        return left->evaluate() / right->evaluate();
+    virtual YxlangNodeType type() const {
+        return NT_DIVIDE;
     }
 
-    virtual void print(std::ostream &os, unsigned int depth) const {
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
         os << indent(depth) << "/ divide" << std::endl;
-        left->print(os, depth+1);
-        right->print(os, depth+1);
+        left->print(os, symbols, depth+1);
+        right->print(os, symbols, depth+1);
     }
 };
 
 /** modulo Yxlang node */
 class CNModulo : public YxlangNode {
+public:
     YxlangNode* 	left;
     YxlangNode* 	right;
     
@@ -241,24 +703,25 @@ public:
     explicit CNModulo(YxlangNode* _left, YxlangNode* _right) : YxlangNode(), left(_left), right(_right) {
     }
 
-    virtual ~CNModulo() {
-        delete left;
-        delete right;
+    virtual double evaluate(YxlangContext &calc) const {
+        double leftValue = left->evaluate(calc);
+        return std::fmod(leftValue, right->evaluate(calc));
     }
 
-    virtual double evaluate() const {
-        return std::fmod(left->evaluate(), right->evaluate());
+    virtual YxlangNodeType type() const {
+        return NT_MODULO;
     }
 
-    virtual void print(std::ostream &os, unsigned int depth) const {
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
         os << indent(depth) << "% modulo" << std::endl;
-        left->print(os, depth+1);
-        right->print(os, depth+1);
+        left->print(os, symbols, depth+1);
+        right->print(os, symbols, depth+1);
     }
 };
 
 /** power Yxlang node */
 class CNPower : public YxlangNode {
+public:
     YxlangNode* 	left;
     YxlangNode* 	right;
     
@@ -266,24 +729,25 @@ public:
     explicit CNPower(YxlangNode* _left, YxlangNode* _right) : YxlangNode(), left(_left), right(_right) {
     }
 
-    virtual ~CNPower() {
-        delete left;
-        delete right;
+    virtual double evaluate(YxlangContext &calc) const {
+        double leftValue = left->evaluate(calc);
+        return std::pow(leftValue, right->evaluate(calc));
     }
 
-    virtual double evaluate() const {
-        return std::pow(left->evaluate(), right->evaluate());
+    virtual YxlangNodeType type() const {
+        return NT_POWER;
     }
 
-    virtual void print(std::ostream &os, unsigned int depth) const {
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
         os << indent(depth) << "^ power" << std::endl;
-        left->print(os, depth+1);
-        right->print(os, depth+1);
+        left->print(os, symbols, depth+1);
+        right->print(os, symbols, depth+1);
     }
 };
 
 /** compare Yxlang node */
 class CNCompare : public YxlangNode {
+public:
     int             fn;
     YxlangNode* 	left;
     YxlangNode* 	right;
@@ -292,15 +756,10 @@ public:
     explicit CNCompare(int _fn, YxlangNode* _left, YxlangNode* _right) : YxlangNode(), fn(_fn), left(_left), right(_right) {
     }
 
-    virtual ~CNCompare() {
-        delete left;
-        delete right;
-    }
-
-    virtual double evaluate() const {
+    virtual double evaluate(YxlangContext &calc) const {
         int v = 0;
-        double leftValue = left->evaluate();
-        double rightValue = right->evaluate();
+        double leftValue = left->evaluate(calc);
+        double rightValue = right->evaluate(calc);
         switch (fn) {
             case 1: {
                 v = leftValue > rightValue ? 1 : 0;
@@ -330,15 +789,20 @@ public:
         return v;
     }
 
-    virtual void print(std::ostream &os, unsigned int depth) const {
+    virtual YxlangNodeType type() const {
+        return NT_COMPARE;
+    }
+
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
         os << indent(depth) << fn << " compare" << std::endl;
-        left->print(os, depth+1);
-        right->print(os, depth+1);
+        left->print(os, symbols, depth+1);
+        right->print(os, symbols, depth+1);
     }
 };
 
 /** unary function Yxlang node */
 class CNUnaryFunction : public YxlangNode {
+public:
     int             fn;
     YxlangNode* 	left;
     YxlangNode* 	right;
@@ -347,13 +811,9 @@ public:
     explicit CNUnaryFunction(int _fn, YxlangNode* _left, YxlangNode* _right = NULL) : YxlangNode(), fn(_fn), left(_left), right(_right) {
     }
 
-    virtual ~CNUnaryFunction() {
-        delete left;
-    }
-
-    virtual double evaluate() const {
+    virtual double evaluate(YxlangContext &calc) const {
         double v = 0;
-        double leftValue = left->evaluate();
+        double leftValue = left->evaluate(calc);
         switch (fn) {
             case 1: {
                 v = sqrt(leftValue);
@@ -368,22 +828,27 @@ public:
                 break;
             }
             case 4: {
-                std::cout << "= " << v << std::endl;
                 v = leftValue;
+                std::cout << "= " << v << std::endl;
                 break;
             }
         }
 	    return v;
     }
 
-    virtual void print(std::ostream &os, unsigned int depth) const {
+    virtual YxlangNodeType type() const {
+        return NT_UNARYFUNCTION;
+    }
+
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
         os << indent(depth) << fn << " unaryfunction" << std::endl;
-        left->print(os, depth+1);
+        left->print(os, symbols, depth+1);
     }
 };
 
 /** baniry function Yxlang node */
 class CNBinaryFunction : public YxlangNode {
+public:
     int             fn;
     YxlangNode* 	left;
     YxlangNode* 	right;
@@ -392,14 +857,9 @@ public:
     explicit CNBinaryFunction(int _fn, YxlangNode* _left, YxlangNode* _right ) : YxlangNode(), fn(_fn), left(_left), right(_right) {
     }
 
-    virtual ~CNBinaryFunction() {
-        delete left;
-        delete right;
-    }
-
-    virtual double evaluate() const {
-        double leftValue = left->evaluate();
-        double rightValue = right->evaluate();
+    virtual double evaluate(YxlangContext &calc) const {
+        double leftValue = left->evaluate(calc);
+        double rightValue = right->evaluate(calc);
         double v = 0;
         switch (fn) {
             case 1: {
@@ -411,10 +871,14 @@ public:
 	    return v;
     }
 
-    virtual void print(std::ostream &os, unsigned int depth) const {
+    virtual YxlangNodeType type() const {
+        return NT_BINARYFUNCTION;
+    }
+
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
         os << indent(depth) << fn << " binaryfunction" << std::endl;
-        left->print(os, depth+1);
-        right->print(os, depth+1);
+        left->print(os, symbols, depth+1);
+        right->print(os, symbols, depth+1);
     }
 };
 
@@ -428,56 +892,71 @@ public:
     explicit CNExprlist(YxlangNode* _left, YxlangNode* _right = NULL) : YxlangNode(), left(_left), right(_right) {
     }
 
-    virtual ~CNExprlist() {
-        delete left;
-        delete right;
+    virtual double evaluate(YxlangContext &calc) const {
+        double leftValue = left->evaluate(calc);
+        //double rightValue = right->evaluate(calc);
+	    return leftValue;
     }
 
-    virtual double evaluate() const {
-        double leftValue = left->evaluate();
-        //double rightValue = right->evaluate();
-	    return leftValue;
+    virtual YxlangNodeType type() const {
+        return NT_EXPRLIST;
     }
 
-    virtual void print(std::ostream &os, unsigned int depth) const {
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
         os << indent(depth) << " exprlist" << std::endl;
-        left->print(os, depth+1);
+        left->print(os, symbols, depth+1);
         if (right) {
-            right->print(os, depth+1);
+            right->print(os, symbols, depth+1);
         }
     }
 };
 
 /** assignment Yxlang node */
 class CNAssignment : public YxlangNode {
-    std::string* 	name;
+public:
+    unsigned int	symbol;
+    unsigned int	slot;
     YxlangNode* 	left;
     YxlangNode* 	right;
     
 public:
-    explicit CNAssignment(std::string* _name, YxlangNode* _left = NULL) : YxlangNode(), name(_name), left(_left) {
+    explicit CNAssignment(unsigned int _symbol, YxlangNode* _left = NULL) : YxlangNode(), symbol(_symbol), slot(_symbol), left(_left), right(NULL) {
     }
 
-    virtual ~CNAssignment() {
-        delete name;
-        delete left;
-    }
-
-    virtual double evaluate() const {
+    virtual double evaluate(YxlangContext &calc) const {
         double v = 0;
-        v = left->evaluate();
-        setVariable(*name, v);
+        v = left->evaluate(calc);
+        calc.variables[slot] = v;
         return v;
     }
 
-    virtual void print(std::ostream &os, unsigned int depth) const {
-        os << indent(depth) << " assignment:" << *name << std::endl;
-        left->print(os, depth+1);
+    virtual YxlangNodeType type() const {
+        return NT_ASSIGNMENT;
+    }
+
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
+        os << indent(depth) << " assignment:" << symbols.name(symbol) << std::endl;
+        left->print(os, symbols, depth+1);
+    }
+};
+
+/** assignment in the body of a function, sees the bindings of the
+ * embedded program calling it */
+class CNGlobalAssignment : public CNAssignment {
+public:
+    explicit CNGlobalAssignment(unsigned int _symbol, YxlangNode* _left = NULL) : CNAssignment(_symbol, _left) {
+    }
+
+    virtual double evaluate(YxlangContext &calc) const {
+        double v = left->evaluate(calc);
+        calc.variables.bound(slot) = v;
+        return v;
     }
 };
 
 /** condition Yxlang node */
 class CNCondition : public YxlangNode {
+public:
     YxlangNode* 	cond;
     YxlangNode* 	left;
     YxlangNode* 	right;
@@ -486,214 +965,453 @@ public:
     explicit CNCondition(YxlangNode* _cond, YxlangNode* _left, YxlangNode* _right = NULL) : YxlangNode(), cond(_cond), left(_left), right(_right) {
     }
 
-    virtual ~CNCondition() {
-        delete cond;
-        delete left;
-        delete right;
-    }
-
-    virtual double evaluate() const {
+    virtual double evaluate(YxlangContext &calc) const {
         double v = 0;
-        int k = cond->evaluate();
-        if (k != 0) {
-            v = left->evaluate();
+        if (truth(cond->evaluate(calc))) {
+            v = left->evaluate(calc);
         } else {
             if (right) {
-                v = right->evaluate();
+                v = right->evaluate(calc);
             }
         }
         return v;
     }
 
-    virtual void print(std::ostream &os, unsigned int depth) const {
+    virtual YxlangNodeType type() const {
+        return NT_CONDITION;
+    }
+
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
         os << indent(depth) << " condition" << std::endl;
-        cond->print(os, depth+1);
-        left->print(os, depth+1);
+        cond->print(os, symbols, depth+1);
+        left->print(os, symbols, depth+1);
         if (right) {
-            right->print(os, depth+1);
+            right->print(os, symbols, depth+1);
         }
     }
 };
 
-/** statement Yxlang node */
-class CNStatement : public YxlangNode {
-    YxlangNode* 	left;
-    YxlangNode* 	right;
-    
+/** block Yxlang node, statements run in order, the value is that of the
+ * last one. The statements are in one array in the arena, so a long
+ * script is run, printed and copied by a loop rather than by recursion,
+ * and torn down with the arena in one step. */
+class CNBlock : public YxlangNode {
 public:
-    explicit CNStatement(YxlangNode* _left, YxlangNode* _right = NULL) : YxlangNode(), left(_left), right(_right) {
-    }
+    YxlangNode**	statements;
+    unsigned int	count;
 
-    virtual ~CNStatement() {
-        delete left;
-        delete right;
+public:
+    explicit CNBlock(YxlangArena &arena, unsigned int _capacity = 4) : YxlangNode(), statements(NULL), count(0), capacity(0) {
+        reserve(arena, _capacity);
+    }
+
+    /** add node after the last statement, the array doubles when full */
+    void append(YxlangArena &arena, YxlangNode* node) {
+        if (count == capacity)
+            reserve(arena, capacity * 2);
+        statements[count++] = node;
+    }
+
+    /** list followed by node: node if list is NULL, list with node
+     * appended if it is a block, else a new block of the two. The parser
+     * builds statement lists with it, a single statement is no block. */
+    static YxlangNode* join(YxlangArena &arena, YxlangNode* list, YxlangNode* node) {
+        if (!list)
+            return node;
+        if (list->type() != NT_BLOCK) {
+            CNBlock* block = new (arena) CNBlock(arena);
+            block->append(arena, list);
+            list = block;
+        }
+        static_cast<CNBlock*>(list)->append(arena, node);
+        return list;
     }
 
-    virtual double evaluate() const {
+    virtual double evaluate(YxlangContext &calc) const {
         double v = 0;
-        v = left->evaluate();
-        v = right->evaluate();
+        for (unsigned int i = 0; i < count; ++i)
+            v = statements[i]->evaluate(calc);
         return v;
     }
 
-    virtual void print(std::ostream &os, unsigned int depth) const {
-        os << indent(depth) << " statement" << std::endl;
-        left->print(os, depth+1);
-        right->print(os, depth+1);
+    virtual YxlangNodeType type() const {
+        return NT_BLOCK;
+    }
+
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
+        os << indent(depth) << " block" << std::endl;
+        for (unsigned int i = 0; i < count; ++i)
+            statements[i]->print(os, symbols, depth+1);
+    }
+
+private:
+    unsigned int	capacity;
+
+    /** move the statements to an array for n, the old one stays in the
+     * arena until it is released */
+    void reserve(YxlangArena &arena, unsigned int n) {
+        if (n < 2)
+            n = 2;
+        YxlangNode** larger = static_cast<YxlangNode**>(arena.allocate(n * sizeof(YxlangNode*)));
+        std::copy(statements, statements + count, larger);
+        statements = larger;
+        capacity = n;
     }
 };
 
 /** paramlist Yxlang node */
 class CNParamlist : public YxlangNode {
 public:
-    std::string* 	name;
+    unsigned int	symbol;
     YxlangNode* 	left;
     YxlangNode* 	right;
     
 public:
-    explicit CNParamlist(std::string* _name, YxlangNode* _left,  YxlangNode* _right = NULL) : YxlangNode(), name(_name), left(_left), right(_right) {
-    }
-
-    virtual ~CNParamlist() {
-        delete name;
-        delete left;
-        delete right;
+    explicit CNParamlist(unsigned int _symbol, YxlangNode* _left,  YxlangNode* _right = NULL) : YxlangNode(), symbol(_symbol), left(_left), right(_right) {
     }
 
-    virtual double evaluate() const {
+    virtual double evaluate(YxlangContext &) const {
         double v = 0;
         return v;
     }
 
-    virtual void print(std::ostream &os, unsigned int depth) const {
-        os << indent(depth) << " paramlist: " << *name << std::endl;
+    virtual YxlangNodeType type() const {
+        return NT_PARAMLIST;
+    }
+
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
+        os << indent(depth) << " paramlist: " << symbols.name(symbol) << std::endl;
         if (left){
-            left->print(os, depth+1);
+            left->print(os, symbols, depth+1);
         }
         if (right) {
-            right->print(os, depth+1);
+            right->print(os, symbols, depth+1);
         }
     }
 };
 
-/** custom function Yxlang node */
+/** parameter of the function whose body holds the node, read from the
+ * activation record of the current call */
+class CNParameter : public YxlangNode {
+public:
+    unsigned int	symbol;
+    /// position in the parameter list, the slot in the record
+    unsigned int	index;
+
+public:
+    explicit CNParameter(unsigned int _symbol, unsigned int _index) : YxlangNode(), symbol(_symbol), index(_index) {
+    }
+
+    virtual double evaluate(YxlangContext &calc) const {
+        return calc.frames[calc.frame + index];
+    }
+
+    virtual YxlangNodeType type() const {
+        return NT_PARAMETER;
+    }
+
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
+        os << indent(depth) << symbols.name(symbol) << ":param " << index << std::endl;
+    }
+};
+
+/** assignment to a parameter, only the current call sees the new value */
+class CNParameterAssignment : public YxlangNode {
+public:
+    unsigned int	symbol;
+    unsigned int	index;
+    YxlangNode* 	left;
+
+public:
+    explicit CNParameterAssignment(unsigned int _symbol, unsigned int _index, YxlangNode* _left) : YxlangNode(), symbol(_symbol), index(_index), left(_left) {
+    }
+
+    virtual double evaluate(YxlangContext &calc) const {
+        /* the value first, a call in it may move the records */
+        double v = left->evaluate(calc);
+        calc.frames[calc.frame + index] = v;
+        return v;
+    }
+
+    virtual YxlangNodeType type() const {
+        return NT_PARAMASSIGN;
+    }
+
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
+        os << indent(depth) << " assignment:" << symbols.name(symbol) << " param " << index << std::endl;
+        left->print(os, symbols, depth+1);
+    }
+};
+
+/** custom function Yxlang node. A call gets an activation record on top
+ * of the context's frames with one slot per parameter. The body reads and
+ * assigns its parameters through CNParameter and CNParameterAssignment
+ * nodes, every other name is a global variable. */
 class CNCustomFunction : public YxlangNode {
 public:
-    std::string*     name;
+    unsigned int	symbol;
     /// paramlist
     YxlangNode* 	left;
     /// sentencelist
     YxlangNode* 	right;
+    /// length of the parameter list
+    unsigned int	nparams;
+    /// numbers the definitions of a context as they are parsed. Unlike
+    /// the address it is not reused once the arena is freed.
+    unsigned long	serial;
+    /// arena the definition was parsed into, held while it is current
+    YxlangArena*	arena;
     
 public:
-    explicit CNCustomFunction(std::string* _name, YxlangNode* _left, YxlangNode* _right) : YxlangNode(), name(_name), left(_left), right(_right) {
+    explicit CNCustomFunction(unsigned int _symbol, YxlangNode* _left, YxlangNode* _right) : YxlangNode(), symbol(_symbol), left(_left), right(_right), nparams(0), serial(0), arena(NULL) {
+        for (const YxlangNode* p = left; p && p->type() == NT_PARAMLIST; p = static_cast<const CNParamlist*>(p)->left)
+            ++nparams;
     }
 
-    virtual ~CNCustomFunction() {
-        /// delete name;
-        /// delete left;
-        /// delete right;
-    }
-
-    virtual double evaluate() const {
+    virtual double evaluate(YxlangContext &calc) const {
         double v = 0;
-        CNCustomFunction* copy = new CNCustomFunction(name, left, right);
-        setFunction(*name, copy);
+        /* the parser pinned the arena, so this node outlives its expression */
+        calc.setFunction(symbol, this);
         return v;
     }
 
-    virtual void print(std::ostream &os, unsigned int depth) const {
-        os << indent(depth) << " function:" << *name << std::endl;
-        left->print(os, depth+1);
-        right->print(os, depth+1);
+    /** turn the names of parameters in the body into CNParameter and
+     * CNParameterAssignment nodes from arena, and the other names into
+     * CNGlobalVariable and CNGlobalAssignment. Called once by the parser.
+     * A parameter named twice is the later argument. The bodies of nested
+     * definitions are left alone, they were resolved against their own
+     * parameters. */
+    void	resolve(YxlangArena &arena);
+
+    /** push a record with the arguments, missing ones are 0, and run the
+     * body. Used by the engines. */
+    double invoke(YxlangContext &calc, const double* args, unsigned int nargs) const {
+        size_t base = calc.top;
+        for (unsigned int i = 0; i < nparams; ++i)
+            calc.push(i < nargs ? args[i] : 0);
+        return call(calc, base);
+    }
+
+    /** call with the record at base, which holds at least nparams values,
+     * and pop the record. If the context caches results and the function
+     * is pure, a cached result is returned without running the body. */
+    double	call(YxlangContext &calc, size_t base) const;
+
+    /** run the body on the record at base and pop the record. A call in
+     * tail position, the last statement of the body or of a branch of an
+     * if that is, replaces the record and continues with the callee's body
+     * in the same loop, so tail recursion runs in constant stack space. */
+    double	run(YxlangContext &calc, size_t base) const;
+
+    virtual YxlangNodeType type() const {
+        return NT_CUSTOMFUNCTION;
+    }
+
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
+        os << indent(depth) << " function:" << symbols.name(symbol) << std::endl;
+        left->print(os, symbols, depth+1);
+        right->print(os, symbols, depth+1);
     }
 };
 
 /** call UDF Yxlang node */
 class CNCallUDF : public YxlangNode {
-    std::string*     name;
+public:
+    unsigned int	symbol;
     /// exprlist
     YxlangNode* 	left;
     YxlangNode* 	right;
     
 public:
-    explicit CNCallUDF(std::string* _name, YxlangNode* _left, YxlangNode*  _right = NULL) : YxlangNode(), name(_name), left(_left), right(_right) {
+    explicit CNCallUDF(unsigned int _symbol, YxlangNode* _left, YxlangNode*  _right = NULL) : YxlangNode(), symbol(_symbol), left(_left), right(_right) {
     }
 
-    virtual ~CNCallUDF() {
-        delete name;
-        delete left;
-        delete right;
-    }
+    /** the argument expressions of a call, in order:
+     *
+     *     for (CNCallUDF::Arguments a(call); !a.done(); a.next())
+     *         compile(a.node());
+     */
+    class Arguments {
+    public:
+        explicit Arguments(const CNCallUDF* call) : list(call->left) {
+        }
 
-    virtual double evaluate() const {
-        double v = 0;
-        CNCustomFunction* func = getFunction(*name);
-        if (func) {
-            std::map<std::string, double> oldVal;
-            CNParamlist* paramnode = dynamic_cast<CNParamlist*>(func->left);
-            CNExprlist* exprnode = dynamic_cast<CNExprlist*>(left);
-            while (paramnode) {
-                std::string* varname = paramnode->name;
-                oldVal[*varname] = getVariable(*varname);
-                double val = 0;
-                if (exprnode) {
-                    val = exprnode->left->evaluate();
-                    exprnode = dynamic_cast<CNExprlist*>(exprnode->right);
-                }
-                setVariable(*varname, val);
-                paramnode = dynamic_cast<CNParamlist*>(paramnode->left);
-            }
+        bool done() const {
+            return !list || list->type() != NT_EXPRLIST;
+        }
+        void next() {
+            list = static_cast<const CNExprlist*>(list)->right;
+        }
+        /** the current argument */
+        const YxlangNode* node() const {
+            return static_cast<const CNExprlist*>(list)->left;
+        }
+        /** the list of the arguments after the current one */
+        const YxlangNode* rest() const {
+            return static_cast<const CNExprlist*>(list)->right;
+        }
 
-            v = func->right->evaluate();
-            /* restore old values */
-            paramnode = dynamic_cast<CNParamlist*>(func->left);
-            while (paramnode) {
-                std::string* varname = paramnode->name;
-                setVariable(*varname, oldVal[*varname]);
-                paramnode = dynamic_cast<CNParamlist*>(paramnode->right);
-            }
+    private:
+        const YxlangNode*	list;
+    };
+
+    /** number of arguments passed */
+    unsigned int nargs() const {
+        unsigned int n = 0;
+        for (Arguments a(this); !a.done(); a.next())
+            ++n;
+        return n;
+    }
+
+    virtual double evaluate(YxlangContext &calc) const {
+        size_t base = calc.top;
+        const CNCustomFunction* func = arguments(calc);
+        return func ? func->call(calc, base) : 0;
+    }
+
+    /** push the record of the call, the arguments padded with 0 to the
+     * callee's parameters, and return the callee. Calls made while
+     * evaluating the arguments push their records above it. If there is no
+     * such function nothing is left pushed and NULL is returned. */
+    const CNCustomFunction* arguments(YxlangContext &calc) const {
+        size_t base = calc.top;
+        unsigned int nargs = 0;
+        for (Arguments a(this); !a.done(); a.next(), ++nargs) {
+            double v = a.node()->evaluate(calc);
+            calc.push(v);
         }
-        return v;
+        const CNCustomFunction* func = calc.getFunction(symbol);
+        if (!func) {
+            calc.top = base;
+            return NULL;
+        }
+        for (; nargs < func->nparams; ++nargs)
+            calc.push(0);
+        return func;
+    }
+
+    virtual YxlangNodeType type() const {
+        return NT_CALLUDF;
     }
 
-    virtual void print(std::ostream &os, unsigned int depth) const {
-        os << indent(depth) << " call UDF:" << *name << std::endl;
-        left->print(os, depth+1);
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
+        os << indent(depth) << " call UDF:" << symbols.name(symbol) << std::endl;
+        left->print(os, symbols, depth+1);
         if (right) {
-            right->print(os, depth+1);
+            right->print(os, symbols, depth+1);
         }
     }
 };
 
-/** Yxlang context  */
-class YxlangContext {
+/** common subexpression, evaluated once and then read by its CNShareRef
+ * nodes. The CSE pass only refers to a share where it is sure to have
+ * been evaluated before, with no assignment to its variables and no UDF
+ * call in between. */
+class CNShare : public YxlangNode {
 public:
-    typedef std::map<std::string, double> variablemap_type;
-    variablemap_type		variables;
-    std::vector<YxlangNode*>	expressions;
+    YxlangNode* 	node;
+    /// value of the latest evaluation
+    mutable double	value;
+    int	id;
 
-    ~YxlangContext() {
-        clearExpressions();
+public:
+    explicit CNShare(YxlangNode* _node, int _id = 0) : YxlangNode(), node(_node), value(0), id(_id) {
     }
 
-    void clearExpressions() {
-        for(unsigned int i = 0; i < expressions.size(); ++i) {
-            delete expressions[i];
+    virtual double evaluate(YxlangContext &calc) const {
+        value = node->evaluate(calc);
+        return value;
+    }
+
+    virtual YxlangNodeType type() const {
+        return NT_SHARE;
+    }
+
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
+        os << indent(depth) << " shared #" << id << std::endl;
+        node->print(os, symbols, depth+1);
+    }
+};
+
+/** later occurrence of a common subexpression, does not own the share */
+class CNShareRef : public YxlangNode {
+public:
+    const CNShare*	share;
+
+public:
+    explicit CNShareRef(const CNShare* _share) : YxlangNode(), share(_share) {
+    }
+
+    virtual double evaluate(YxlangContext &) const {
+        return share->value;
+    }
+
+    virtual YxlangNodeType type() const {
+        return NT_SHAREREF;
+    }
+
+    virtual void print(std::ostream &os, const YxlangSymbols &, unsigned int depth) const {
+        os << indent(depth) << " shared ref #" << share->id << std::endl;
+    }
+};
+
+/** guard of an inlined call, 1 while the function named symbol is still
+ * the definition whose body was inlined. The optimizer puts it in the
+ * condition of an if that runs the inlined body, or the original call once
+ * the name has been redefined. The definition is known by its serial, it
+ * may be freed while the guard lives on in a cached parse. */
+class CNGuard : public YxlangNode {
+public:
+    unsigned int	symbol;
+    unsigned long	serial;
+
+public:
+    explicit CNGuard(unsigned int _symbol, unsigned long _serial) : YxlangNode(), symbol(_symbol), serial(_serial), checked(~0UL), holds(false) {
+    }
+
+    /** true if the definition numbered serial is the current one of
+     * symbol in calc */
+    bool check(YxlangContext &calc) const {
+        if (checked != calc.definitions) {
+            const CNCustomFunction* function = calc.getFunction(symbol);
+            holds = function && function->serial == serial;
+            checked = calc.definitions;
         }
-        expressions.clear();
+        return holds;
     }
 
-    bool existsVariable(const std::string &varname) const {
-        return variables.find(varname) != variables.end();
+    virtual double evaluate(YxlangContext &calc) const {
+        return check(calc) ? 1 : 0;
     }
-    double	getVariable(const std::string &varname) const {
-        variablemap_type::const_iterator vi = variables.find(varname);
-        if (vi == variables.end())
-            return 0;
-        else
-            return vi->second;
+
+    virtual YxlangNodeType type() const {
+        return NT_GUARD;
+    }
+
+    virtual void print(std::ostream &os, const YxlangSymbols &symbols, unsigned int depth) const {
+        os << indent(depth) << " guard:" << symbols.name(symbol) << std::endl;
     }
+
+private:
+    /// calc.definitions when holds was found
+    mutable unsigned long	checked;
+    mutable bool	holds;
 };
 
+/** compiled form of one expression, produced by an execution engine */
+class YxlangProgram {
+public:
+    virtual ~YxlangProgram() {
+    }
+
+    virtual double	run(YxlangContext &calc) = 0;
+};
+
+inline double YxlangContext::evaluate(unsigned int index) {
+    /* run a program compiled against the current variable array right away */
+    if (index < programs.size() && programs[index] && base == variables.data())
+        return programs[index]->run(*this);
+    return compileAndEvaluate(index);
+}
+
 #endif // EXPRESSION_H
@@ -7,8 +7,41 @@
 
 #include <iostream>
 #include <fstream>
+#include <stdlib.h>
 #include "driver.h"
 #include "expression.h"
+#include "optimizer.h"
+#include "memo.h"
+#include "parsecache.h"
+
+static bool parseEngine(const std::string &name, YxlangEngine &engine) {
+    if (name == "tree") {
+        engine = ENGINE_TREE;
+    } else if (name == "stack") {
+        engine = ENGINE_STACK;
+    } else if (name == "register") {
+        engine = ENGINE_REGISTER;
+    } else if (name == "jit") {
+        engine = ENGINE_JIT;
+    } else if (name == "closure") {
+        engine = ENGINE_CLOSURE;
+    } else if (name == "flat") {
+        engine = ENGINE_FLAT;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static void printMemos(const YxlangContext &calc) {
+    for (YxlangContext::memomap_type::const_iterator mi = calc.memos.begin(); mi != calc.memos.end(); ++mi) {
+        std::cout << "memo " << calc.symbols.name(mi->first) << ": ";
+        if (mi->second)
+            std::cout << mi->second->hits << " hits, " << mi->second->misses << " misses, " << mi->second->size() << " cached" << std::endl;
+        else
+            std::cout << "impure" << std::endl;
+    }
+}
 
 int main(int argc, char *argv[]) {
     YxlangContext calc;
@@ -20,23 +53,45 @@ int main(int argc, char *argv[]) {
             driver.trace_parsing = true;
         } else if (argv[ai] == std::string ("-s")) {
             driver.trace_scanning = true;
+        } else if (argv[ai] == std::string ("-O")) {
+            driver.optimize_level = OPTIMIZE_SAFE;
+        } else if (argv[ai] == std::string ("-Ofast")) {
+            driver.optimize_level = OPTIMIZE_FAST;
+        } else if (argv[ai] == std::string ("-e") && ai + 1 < argc) {
+            YxlangEngine engine;
+            if (!parseEngine(argv[++ai], engine)) {
+                std::cerr << "Unknown engine: " << argv[ai] << " (tree, stack, register, jit, closure, flat)" << std::endl;
+                return 1;
+            }
+            calc.setEngine(engine);
+        } else if (argv[ai] == std::string ("-m") && ai + 1 < argc) {
+            calc.setMemoize(strtoul(argv[++ai], NULL, 10));
+        } else if (argv[ai] == std::string ("-c") && ai + 1 < argc) {
+            driver.setCache(strtoul(argv[++ai], NULL, 10));
+        } else if (argv[ai] == std::string ("-S")) {
+            driver.streaming = true;
+            driver.executed = [](const YxlangNode*, double value) {
+                std::cout << "evaluated: " << value << std::endl;
+            };
         } else {
             std::fstream infile(argv[ai]);
             if (!infile.good()) {
                 std::cerr << "Could not open file: " << argv[ai] << std::endl;
                 return 0;
             }
+            infile.close();
 
             calc.clearExpressions();
-            bool result = driver.parse_stream(infile, argv[ai]);
-            if (result) {
+            bool result = driver.parse_file(argv[ai]);
+            if (result && !driver.streaming) {
                 std::cout << "Expressions:" << std::endl;
                 for (unsigned int ei = 0; ei < calc.expressions.size(); ++ei) {
                     std::cout << "[" << ei << "]:" << std::endl;
                     std::cout << "tree:" << std::endl;
-                    calc.expressions[ei]->print(std::cout);
-                    std::cout << "evaluated: " << calc.expressions[ei]->evaluate() << std::endl;
+                    calc.expressions[ei]->print(std::cout, calc.symbols);
+                    std::cout << "evaluated: " << calc.evaluate(ei) << std::endl;
                 }
+                printMemos(calc);
             }
 
             readfile = true;
@@ -56,9 +111,13 @@ int main(int argc, char *argv[]) {
         if (result) {
             for (unsigned int ei = 0; ei < calc.expressions.size(); ++ei) {
                 std::cout << "tree:" << std::endl;
-                calc.expressions[ei]->print(std::cout);
-                std::cout << "evaluated: " << calc.expressions[ei]->evaluate() << std::endl;
+                calc.expressions[ei]->print(std::cout, calc.symbols);
+                std::cout << "evaluated: " << calc.evaluate(ei) << std::endl;
             }
         }
     }
+
+    const YxlangParseCache* cache = driver.getCache();
+    if (cache)
+        std::cout << "cache: " << cache->hits << " hits, " << cache->misses << " misses, " << cache->size() << " cached" << std::endl;
 }
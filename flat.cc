@@ -0,0 +1,300 @@
+/**
+ * @file flat.cc
+ * @brief flat struct-of-arrays tree, evaluated by a forward scan
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <string.h>
+#include <cmath>
+#include <iostream>
+#include "flat.h"
+
+FlatProgram* FlatCompiler::compile(const YxlangNode* node) {
+    FlatProgram* program = new FlatProgram();
+    FlatCompiler compiler(program);
+    compiler.constant(0);
+    compiler.hoist(node);
+    program->first = program->values.size();
+    compiler.emit(FOP_HALT, compiler.compileNode(node));
+    return program;
+}
+
+void FlatCompiler::hoist(const YxlangNode* node) {
+    if (!node)
+        return;
+    if (node->type() == NT_CONSTANT) {
+        constant(static_cast<const CNConstant*>(node)->value);
+        return;
+    }
+    /* a function body is run by the tree walker */
+    if (node->type() == NT_CUSTOMFUNCTION)
+        return;
+    YxlangNode::Children children(node);
+    unsigned int n = children.size();
+    for (unsigned int i = 0; i < n; ++i)
+        hoist(children[i]);
+}
+
+uint32_t FlatCompiler::constant(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    std::map<uint64_t, uint32_t>::const_iterator ci = constants.find(bits);
+    if (ci != constants.end())
+        return ci->second;
+    /* constants have no opcode, pad the node arrays to keep them parallel */
+    program->ops.push_back(0);
+    program->a.push_back(0);
+    program->b.push_back(0);
+    program->values.push_back(value);
+    return constants[bits] = program->values.size() - 1;
+}
+
+uint32_t FlatCompiler::emit(FlatOpcode op, uint32_t a, uint32_t b) {
+    program->ops.push_back(op);
+    program->a.push_back(a);
+    program->b.push_back(b);
+    program->values.push_back(0);
+    return program->values.size() - 1;
+}
+
+uint32_t FlatCompiler::compileBinary(FlatOpcode op, const YxlangNode* left, const YxlangNode* right) {
+    uint32_t l = compileNode(left);
+    uint32_t r = compileNode(right);
+    return emit(op, l, r);
+}
+
+uint32_t FlatCompiler::compileNode(const YxlangNode* node) {
+    if (!node)
+        return constant(0);
+
+    switch (node->type()) {
+        case NT_CONSTANT:
+            return constant(static_cast<const CNConstant*>(node)->value);
+        case NT_VARIABLE:
+            return emit(FOP_LOAD, static_cast<const CNVariable*>(node)->slot);
+        case NT_NEGATE:
+            return emit(FOP_NEG, compileNode(static_cast<const CNNegate*>(node)->node));
+        case NT_ADD: {
+            const CNAdd* n = static_cast<const CNAdd*>(node);
+            return compileBinary(FOP_ADD, n->left, n->right);
+        }
+        case NT_SUBTRACT: {
+            const CNSubtract* n = static_cast<const CNSubtract*>(node);
+            return compileBinary(FOP_SUB, n->left, n->right);
+        }
+        case NT_MULTIPLY: {
+            const CNMultiply* n = static_cast<const CNMultiply*>(node);
+            return compileBinary(FOP_MUL, n->left, n->right);
+        }
+        case NT_DIVIDE: {
+            const CNDivide* n = static_cast<const CNDivide*>(node);
+            return compileBinary(FOP_DIV, n->left, n->right);
+        }
+        case NT_MODULO: {
+            const CNModulo* n = static_cast<const CNModulo*>(node);
+            return compileBinary(FOP_MOD, n->left, n->right);
+        }
+        case NT_POWER: {
+            const CNPower* n = static_cast<const CNPower*>(node);
+            return compileBinary(FOP_POW, n->left, n->right);
+        }
+        case NT_BINARYFUNCTION: {
+            const CNBinaryFunction* n = static_cast<const CNBinaryFunction*>(node);
+            return compileBinary(FOP_POW, n->left, n->right);
+        }
+        case NT_COMPARE: {
+            const CNCompare* n = static_cast<const CNCompare*>(node);
+            FlatOpcode op = FOP_GT;
+            switch (n->fn) {
+                case CMP_GT: op = FOP_GT; break;
+                case CMP_LT: op = FOP_LT; break;
+                case CMP_NE: op = FOP_NE; break;
+                case CMP_EQ: op = FOP_EQ; break;
+                case CMP_GE: op = FOP_GE; break;
+                case CMP_LE: op = FOP_LE; break;
+            }
+            return compileBinary(op, n->left, n->right);
+        }
+        case NT_UNARYFUNCTION: {
+            const CNUnaryFunction* n = static_cast<const CNUnaryFunction*>(node);
+            FlatOpcode op = FOP_SQRT;
+            switch (n->fn) {
+                case UF_SQRT: op = FOP_SQRT; break;
+                case UF_EXP: op = FOP_EXP; break;
+                case UF_LOG: op = FOP_LOG; break;
+                case UF_PRINT: op = FOP_PRINT; break;
+            }
+            return emit(op, compileNode(n->left));
+        }
+        case NT_EXPRLIST:
+            return compileNode(static_cast<const CNExprlist*>(node)->left);
+        case NT_ASSIGNMENT: {
+            const CNAssignment* n = static_cast<const CNAssignment*>(node);
+            return emit(FOP_STORE, compileNode(n->left), n->slot);
+        }
+        case NT_CONDITION: {
+            const CNCondition* n = static_cast<const CNCondition*>(node);
+            uint32_t jumpf = emit(FOP_JUMPF, compileNode(n->cond));
+            uint32_t jump = emit(FOP_JUMP, compileNode(n->left));
+            program->b[jumpf] = program->values.size();
+            uint32_t move = emit(FOP_MOVE, compileNode(n->right));
+            program->b[jump] = move;
+            return move;
+        }
+        case NT_BLOCK: {
+            const CNBlock* n = static_cast<const CNBlock*>(node);
+            for (unsigned int i = 0; i + 1 < n->count; ++i)
+                compileNode(n->statements[i]);
+            return compileNode(n->count ? n->statements[n->count - 1] : NULL);
+        }
+        /* parameters only occur in function bodies, the tree walker runs them */
+        case NT_PARAMETER:
+        case NT_PARAMASSIGN:
+        case NT_PARAMLIST:
+            return constant(0);
+        case NT_CUSTOMFUNCTION:
+            program->functions.push_back(static_cast<const CNCustomFunction*>(node));
+            return emit(FOP_DEFINE, program->functions.size() - 1);
+        case NT_GUARD:
+            program->guards.push_back(static_cast<const CNGuard*>(node));
+            return emit(FOP_GUARD, program->guards.size() - 1);
+        case NT_CALLUDF: {
+            const CNCallUDF* n = static_cast<const CNCallUDF*>(node);
+            std::vector<uint32_t> args;
+            for (CNCallUDF::Arguments a(n); !a.done(); a.next())
+                args.push_back(compileNode(a.node()));
+            uint32_t at = program->calls.size();
+            program->calls.push_back(n->symbol);
+            program->calls.insert(program->calls.end(), args.begin(), args.end());
+            return emit(FOP_CALL, at, args.size());
+        }
+        case NT_SHARE: {
+            const CNShare* n = static_cast<const CNShare*>(node);
+            /* values are never overwritten, later references read it in place */
+            return shares[n] = compileNode(n->node);
+        }
+        case NT_SHAREREF:
+            return shares[static_cast<const CNShareRef*>(node)->share];
+    }
+    return constant(0);
+}
+
+double FlatProgram::run(YxlangContext &calc) {
+    static const void* const labels[FOP_COUNT] = {
+        &&op_load, &&op_store, &&op_move, &&op_neg,
+        &&op_add, &&op_sub, &&op_mul, &&op_div, &&op_mod, &&op_pow,
+        &&op_gt, &&op_lt, &&op_ne, &&op_eq, &&op_ge, &&op_le,
+        &&op_sqrt, &&op_exp, &&op_log, &&op_print,
+        &&op_jumpf, &&op_jump, &&op_call, &&op_define, &&op_guard, &&op_halt
+    };
+    const uint8_t* op = &ops[0];
+    const uint32_t* pa = &a[0];
+    const uint32_t* pb = &b[0];
+    double* v = &values[0];
+    double* vars = calc.variables.data();
+    uint32_t i = first;
+
+#define DISPATCH()  goto *labels[op[i]]
+#define NEXT()      do { ++i; DISPATCH(); } while (0)
+
+    DISPATCH();
+
+op_load:
+    v[i] = vars[pa[i]];
+    NEXT();
+op_store:
+    v[i] = vars[pb[i]] = v[pa[i]];
+    NEXT();
+op_move:
+    v[i] = v[pa[i]];
+    NEXT();
+op_neg:
+    v[i] = - v[pa[i]];
+    NEXT();
+op_add:
+    v[i] = v[pa[i]] + v[pb[i]];
+    NEXT();
+op_sub:
+    v[i] = v[pa[i]] - v[pb[i]];
+    NEXT();
+op_mul:
+    v[i] = v[pa[i]] * v[pb[i]];
+    NEXT();
+op_div:
+    v[i] = v[pa[i]] / v[pb[i]];
+    NEXT();
+op_mod:
+    v[i] = std::fmod(v[pa[i]], v[pb[i]]);
+    NEXT();
+op_pow:
+    v[i] = std::pow(v[pa[i]], v[pb[i]]);
+    NEXT();
+op_gt:
+    v[i] = v[pa[i]] > v[pb[i]] ? 1 : 0;
+    NEXT();
+op_lt:
+    v[i] = v[pa[i]] < v[pb[i]] ? 1 : 0;
+    NEXT();
+op_ne:
+    v[i] = v[pa[i]] != v[pb[i]] ? 1 : 0;
+    NEXT();
+op_eq:
+    v[i] = v[pa[i]] == v[pb[i]] ? 1 : 0;
+    NEXT();
+op_ge:
+    v[i] = v[pa[i]] >= v[pb[i]] ? 1 : 0;
+    NEXT();
+op_le:
+    v[i] = v[pa[i]] <= v[pb[i]] ? 1 : 0;
+    NEXT();
+op_sqrt:
+    v[i] = std::sqrt(v[pa[i]]);
+    NEXT();
+op_exp:
+    v[i] = std::exp(v[pa[i]]);
+    NEXT();
+op_log:
+    v[i] = std::log(v[pa[i]]);
+    NEXT();
+op_print:
+    v[i] = v[pa[i]];
+    std::cout << "= " << v[i] << std::endl;
+    NEXT();
+op_jumpf:
+    if (!YxlangNode::truth(v[pa[i]])) {
+        i = pb[i];
+        DISPATCH();
+    }
+    NEXT();
+op_jump:
+    v[pb[i]] = v[pa[i]];
+    i = pb[i];
+    NEXT();
+op_call: {
+        const uint32_t* call = &calls[pa[i]];
+        double local[8];
+        std::vector<double> heap;
+        double* args = local;
+        if (pb[i] > 8) {
+            heap.resize(pb[i]);
+            args = &heap[0];
+        }
+        for (uint32_t k = 0; k < pb[i]; ++k)
+            args[k] = v[call[k + 1]];
+        YxlangContext::functionmap_type::const_iterator fi = calc.functions.find(call[0]);
+        v[i] = fi == calc.functions.end() ? 0 : fi->second->invoke(calc, args, pb[i]);
+    }
+    NEXT();
+op_define:
+    v[i] = functions[pa[i]]->evaluate(calc);
+    NEXT();
+op_guard:
+    v[i] = guards[pa[i]]->check(calc) ? 1 : 0;
+    NEXT();
+op_halt:
+    return v[pa[i]];
+
+#undef NEXT
+#undef DISPATCH
+}
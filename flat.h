@@ -0,0 +1,110 @@
+/**
+ * @file flat.h
+ * @brief flat struct-of-arrays tree, evaluated by a forward scan
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#ifndef FLAT_H
+#define FLAT_H
+
+#include <stdint.h>
+#include <vector>
+#include <map>
+#include "expression.h"
+
+/** flat node opcodes. Every node writes values[i] from the values of its
+ * children, a and b are node indices unless noted. */
+enum FlatOpcode {
+    /// values[i] = variable slot a
+    FOP_LOAD,
+    /// variable slot b = values[i] = values[a]
+    FOP_STORE,
+    /// values[i] = values[a], ends the else branch of a condition
+    FOP_MOVE,
+    FOP_NEG,
+    FOP_ADD,
+    FOP_SUB,
+    FOP_MUL,
+    FOP_DIV,
+    FOP_MOD,
+    FOP_POW,
+    FOP_GT,
+    FOP_LT,
+    FOP_NE,
+    FOP_EQ,
+    FOP_GE,
+    FOP_LE,
+    FOP_SQRT,
+    FOP_EXP,
+    FOP_LOG,
+    FOP_PRINT,
+    /// continue at node b if values[a] is false
+    FOP_JUMPF,
+    /// values[b] = values[a], continue at node b + 1. Ends the then branch
+    /// of a condition, b is the FOP_MOVE ending its else branch.
+    FOP_JUMP,
+    /// call the UDF with symbol id calls[a] on the b nodes calls[a+1] ..
+    FOP_CALL,
+    /// register the function definition functions[a], values[i] = 0
+    FOP_DEFINE,
+    /// values[i] = 1 if the inlined function of guards[a] is still defined, else 0
+    FOP_GUARD,
+    /// return values[a]
+    FOP_HALT,
+    FOP_COUNT
+};
+
+/** A tree laid out as parallel arrays in post-order, a one byte opcode and
+ * two 32 bit child indices per node, 9 bytes plus its value. Constants are
+ * hoisted in front of the nodes, statements and shared subexpressions
+ * take the index of the node giving their value, so evaluation is one
+ * forward scan over the nodes with a jump per condition, dispatched
+ * through a table of labels. */
+class FlatProgram : public YxlangProgram {
+public:
+    std::vector<uint8_t>	ops;
+    std::vector<uint32_t>	a;
+    std::vector<uint32_t>	b;
+    /// index of the first node, the constants come before it
+    uint32_t	first;
+    /// symbol ids and argument indices of the calls
+    std::vector<uint32_t>	calls;
+    std::vector<const CNCustomFunction*>	functions;
+    std::vector<const CNGuard*>	guards;
+
+    FlatProgram() : first(0) {
+    }
+
+    /** reads and writes the variables of calc by slot */
+    virtual double	run(YxlangContext &calc);
+
+private:
+    friend class FlatCompiler;
+
+    /// value of every constant and node
+    std::vector<double>	values;
+};
+
+/** lays a Yxlang tree out as a FlatProgram */
+class FlatCompiler {
+public:
+    static FlatProgram* compile(const YxlangNode* node);
+
+private:
+    explicit FlatCompiler(FlatProgram* _program) : program(_program) {
+    }
+
+    void	hoist(const YxlangNode* node);
+    uint32_t	constant(double value);
+    uint32_t	compileNode(const YxlangNode* node);
+    uint32_t	compileBinary(FlatOpcode op, const YxlangNode* left, const YxlangNode* right);
+    uint32_t	emit(FlatOpcode op, uint32_t a = 0, uint32_t b = 0);
+
+    FlatProgram*	program;
+    /// constant indices by the bits of their value
+    std::map<uint64_t, uint32_t>	constants;
+    std::map<const CNShare*, uint32_t>	shares;
+};
+
+#endif // FLAT_H
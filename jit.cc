@@ -0,0 +1,388 @@
+/**
+ * @file jit.cc
+ * @brief x86-64 native code generator for arithmetic expressions
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <string.h>
+#include <cmath>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "jit.h"
+
+JitProgram::~JitProgram() {
+    if (code)
+        munmap(code, codesize);
+}
+
+double JitProgram::run(YxlangContext &calc) {
+    double v = 0;
+    double* const* s = slots.empty() ? NULL : &slots[0];
+    for (unsigned int i = 0; i < steps.size(); ++i) {
+        const Step &step = steps[i];
+        v = step.function ? step.function(s) : step.node->evaluate(calc);
+    }
+    return v;
+}
+
+bool JitCompiler::compilable(const YxlangNode* node) {
+    if (!node)
+        return false;
+
+    switch (node->type()) {
+        case NT_CONSTANT:
+        case NT_VARIABLE:
+            return true;
+        case NT_NEGATE:
+            return compilable(static_cast<const CNNegate*>(node)->node);
+        case NT_ADD:
+            return compilable(static_cast<const CNAdd*>(node)->left) && compilable(static_cast<const CNAdd*>(node)->right);
+        case NT_SUBTRACT:
+            return compilable(static_cast<const CNSubtract*>(node)->left) && compilable(static_cast<const CNSubtract*>(node)->right);
+        case NT_MULTIPLY:
+            return compilable(static_cast<const CNMultiply*>(node)->left) && compilable(static_cast<const CNMultiply*>(node)->right);
+        case NT_DIVIDE:
+            return compilable(static_cast<const CNDivide*>(node)->left) && compilable(static_cast<const CNDivide*>(node)->right);
+        case NT_MODULO:
+            return compilable(static_cast<const CNModulo*>(node)->left) && compilable(static_cast<const CNModulo*>(node)->right);
+        case NT_POWER:
+            return compilable(static_cast<const CNPower*>(node)->left) && compilable(static_cast<const CNPower*>(node)->right);
+        case NT_COMPARE:
+            return compilable(static_cast<const CNCompare*>(node)->left) && compilable(static_cast<const CNCompare*>(node)->right);
+        case NT_UNARYFUNCTION: {
+            const CNUnaryFunction* n = static_cast<const CNUnaryFunction*>(node);
+            return n->fn != UF_PRINT && compilable(n->left);
+        }
+        case NT_BINARYFUNCTION:
+            return compilable(static_cast<const CNBinaryFunction*>(node)->left) && compilable(static_cast<const CNBinaryFunction*>(node)->right);
+        case NT_ASSIGNMENT:
+            return compilable(static_cast<const CNAssignment*>(node)->left);
+        case NT_BLOCK: {
+            const CNBlock* n = static_cast<const CNBlock*>(node);
+            for (unsigned int i = 0; i < n->count; ++i) {
+                if (!compilable(n->statements[i]))
+                    return false;
+            }
+            return true;
+        }
+        case NT_SHARE:
+            return compilable(static_cast<const CNShare*>(node)->node);
+        case NT_SHAREREF:
+            return true;
+        default:
+            return false;
+    }
+}
+
+JitProgram* JitCompiler::compile(YxlangContext &calc, const YxlangNode* node) {
+    JitProgram* program = new JitProgram();
+#if defined(__x86_64__)
+    JitCompiler compiler(calc, program);
+    std::vector<const YxlangNode*> nodes;
+    compiler.split(node, nodes);
+
+    /* consecutive compilable statements share one native function */
+    std::vector<long> offsets;
+    for (unsigned int i = 0; i < nodes.size(); ) {
+        JitProgram::Step step;
+        step.function = NULL;
+        step.node = nodes[i];
+        program->steps.push_back(step);
+        if (!compilable(nodes[i])) {
+            offsets.push_back(-1);
+            ++i;
+            continue;
+        }
+        std::vector<const YxlangNode*> run;
+        while (i < nodes.size() && compilable(nodes[i]))
+            run.push_back(nodes[i++]);
+        offsets.push_back(compiler.buffer.size());
+        compiler.compileFunction(run);
+    }
+
+    if (!compiler.buffer.empty()) {
+        size_t pagesize = sysconf(_SC_PAGESIZE);
+        size_t size = (compiler.buffer.size() + pagesize - 1) / pagesize * pagesize;
+        void* code = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (code != MAP_FAILED) {
+            memcpy(code, &compiler.buffer[0], compiler.buffer.size());
+            if (mprotect(code, size, PROT_READ | PROT_EXEC) == 0) {
+                program->code = code;
+                program->codesize = size;
+            } else {
+                munmap(code, size);
+            }
+        }
+        if (program->code) {
+            for (unsigned int i = 0; i < program->steps.size(); ++i) {
+                if (offsets[i] >= 0) {
+                    unsigned char* entry = static_cast<unsigned char*>(program->code) + offsets[i];
+                    program->steps[i].function = reinterpret_cast<JitProgram::function_type>(entry);
+                }
+            }
+            return program;
+        }
+    }
+#endif
+    /* nothing compiled natively, let the tree walker run it all */
+    program->steps.clear();
+    JitProgram::Step step;
+    step.function = NULL;
+    step.node = node;
+    program->steps.push_back(step);
+    return program;
+}
+
+void JitCompiler::split(const YxlangNode* node, std::vector<const YxlangNode*> &out) {
+    if (node && node->type() == NT_BLOCK) {
+        const CNBlock* n = static_cast<const CNBlock*>(node);
+        for (unsigned int i = 0; i < n->count; ++i)
+            split(n->statements[i], out);
+    } else if (node) {
+        out.push_back(node);
+    }
+}
+
+void JitCompiler::emit32(int v) {
+    emit(reinterpret_cast<const unsigned char*>(&v), 4);
+}
+
+void JitCompiler::emit64(const void* p) {
+    emit(reinterpret_cast<const unsigned char*>(&p), 8);
+}
+
+/* Every node leaves its value in xmm0. rbx holds the slot array, rax is
+ * scratch, and values that must survive the right operand are spilled to
+ * the frame, so calls into libm never need to save registers. */
+void JitCompiler::compileFunction(const std::vector<const YxlangNode*> &nodes) {
+    static const unsigned char prologue[] = {
+        0x53,                   // push rbx
+        0x48, 0x89, 0xfb,       // mov rbx, rdi
+        0x48, 0x81, 0xec        // sub rsp, imm32
+    };
+    emit(prologue, sizeof(prologue));
+    size_t framesize = buffer.size();
+    emit32(0);
+
+    depth = maxdepth = 0;
+    for (unsigned int i = 0; i < nodes.size(); ++i)
+        compileNode(nodes[i]);
+
+    /* rsp is 16 byte aligned after push rbx, keep it so for the calls */
+    int frame = (maxdepth * 8 + 15) / 16 * 16;
+    memcpy(&buffer[framesize], &frame, 4);
+    static const unsigned char epilogue[] = {
+        0x48, 0x81, 0xc4        // add rsp, imm32
+    };
+    emit(epilogue, sizeof(epilogue));
+    emit32(frame);
+    emit(0x5b);                 // pop rbx
+    emit(0xc3);                 // ret
+}
+
+void JitCompiler::loadConstant(double value, int xmm) {
+    emit(0x48);                 // mov rax, imm64
+    emit(0xb8);
+    emit(reinterpret_cast<const unsigned char*>(&value), 8);
+    static const unsigned char movq[] = { 0x66, 0x48, 0x0f, 0x6e };
+    emit(movq, sizeof(movq));   // movq xmm, rax
+    emit(xmm ? 0xc8 : 0xc0);
+}
+
+double* JitCompiler::address(const YxlangNode* node) {
+    if (node->type() == NT_SHAREREF)
+        return &static_cast<const CNShareRef*>(node)->share->value;
+    return &calc.variables[static_cast<const CNVariable*>(node)->slot];
+}
+
+void JitCompiler::loadSlotAddress(double* p) {
+    std::map<const double*, int>::const_iterator si = slotindex.find(p);
+    int slot;
+    if (si == slotindex.end()) {
+        program->slots.push_back(p);
+        slot = slotindex[p] = program->slots.size() - 1;
+    } else {
+        slot = si->second;
+    }
+    static const unsigned char mov[] = { 0x48, 0x8b, 0x83 };
+    emit(mov, sizeof(mov));     // mov rax, [rbx + disp32]
+    emit32(slot * 8);
+}
+
+void JitCompiler::loadLeaf(const YxlangNode* node, int xmm) {
+    if (node->type() == NT_CONSTANT) {
+        loadConstant(static_cast<const CNConstant*>(node)->value, xmm);
+    } else {
+        loadSlotAddress(address(node));
+        static const unsigned char movsd[] = { 0xf2, 0x0f, 0x10 };
+        emit(movsd, sizeof(movsd)); // movsd xmm, [rax]
+        emit(xmm ? 0x08 : 0x00);
+    }
+}
+
+void JitCompiler::emitArith(unsigned char opcode) {
+    emit(0xf2);                 // op xmm0, xmm1
+    emit(0x0f);
+    emit(opcode);
+    emit(0xc1);
+}
+
+void JitCompiler::compileBinary(const YxlangNode* left, const YxlangNode* right) {
+    static const unsigned char movapd10[] = { 0x66, 0x0f, 0x28, 0xc8 };
+    if (leaf(right)) {
+        compileNode(left);
+        loadLeaf(right, 1);
+    } else if (leaf(left)) {
+        compileNode(right);
+        emit(movapd10, sizeof(movapd10));   // movapd xmm1, xmm0
+        loadLeaf(left, 0);
+    } else {
+        compileNode(left);
+        int disp = depth * 8;
+        static const unsigned char store[] = { 0xf2, 0x0f, 0x11, 0x84, 0x24 };
+        emit(store, sizeof(store));         // movsd [rsp + disp32], xmm0
+        emit32(disp);
+        if (++depth > maxdepth)
+            maxdepth = depth;
+        compileNode(right);
+        --depth;
+        emit(movapd10, sizeof(movapd10));   // movapd xmm1, xmm0
+        static const unsigned char load[] = { 0xf2, 0x0f, 0x10, 0x84, 0x24 };
+        emit(load, sizeof(load));           // movsd xmm0, [rsp + disp32]
+        emit32(disp);
+    }
+}
+
+void JitCompiler::compileCall(const void* function) {
+    emit(0x48);                 // mov rax, imm64
+    emit(0xb8);
+    emit64(function);
+    emit(0xff);                 // call rax
+    emit(0xd0);
+}
+
+void JitCompiler::compileCompare(int fn) {
+    /* cmpsd leaves an all ones mask, and it with 1.0. The predicates are
+     * ordered except NEQ, which matches the C++ operators on NaN. */
+    unsigned char predicate = 0;
+    bool swap = false;
+    switch (fn) {
+        case CMP_GT: predicate = 1; swap = true; break;
+        case CMP_LT: predicate = 1; break;
+        case CMP_NE: predicate = 4; break;
+        case CMP_EQ: predicate = 0; break;
+        case CMP_GE: predicate = 2; swap = true; break;
+        case CMP_LE: predicate = 2; break;
+    }
+    static const unsigned char cmpsd[] = { 0xf2, 0x0f, 0xc2 };
+    emit(cmpsd, sizeof(cmpsd));
+    if (swap) {
+        emit(0xc8);             // cmpsd xmm1, xmm0, predicate
+        emit(predicate);
+        static const unsigned char movapd01[] = { 0x66, 0x0f, 0x28, 0xc1 };
+        emit(movapd01, sizeof(movapd01));   // movapd xmm0, xmm1
+    } else {
+        emit(0xc1);             // cmpsd xmm0, xmm1, predicate
+        emit(predicate);
+    }
+    loadConstant(1, 1);
+    static const unsigned char andpd[] = { 0x66, 0x0f, 0x54, 0xc1 };
+    emit(andpd, sizeof(andpd)); // andpd xmm0, xmm1
+}
+
+void JitCompiler::compileNode(const YxlangNode* node) {
+    typedef double (*unary_type)(double);
+    typedef double (*binary_type)(double, double);
+
+    switch (node->type()) {
+        case NT_CONSTANT:
+        case NT_VARIABLE:
+        case NT_SHAREREF:
+            loadLeaf(node, 0);
+            break;
+        case NT_NEGATE: {
+            compileNode(static_cast<const CNNegate*>(node)->node);
+            loadConstant(-0.0, 1);
+            static const unsigned char xorpd[] = { 0x66, 0x0f, 0x57, 0xc1 };
+            emit(xorpd, sizeof(xorpd));     // xorpd xmm0, xmm1
+            break;
+        }
+        case NT_ADD:
+            compileBinary(static_cast<const CNAdd*>(node)->left, static_cast<const CNAdd*>(node)->right);
+            emitArith(0x58);
+            break;
+        case NT_SUBTRACT:
+            compileBinary(static_cast<const CNSubtract*>(node)->left, static_cast<const CNSubtract*>(node)->right);
+            emitArith(0x5c);
+            break;
+        case NT_MULTIPLY:
+            compileBinary(static_cast<const CNMultiply*>(node)->left, static_cast<const CNMultiply*>(node)->right);
+            emitArith(0x59);
+            break;
+        case NT_DIVIDE:
+            compileBinary(static_cast<const CNDivide*>(node)->left, static_cast<const CNDivide*>(node)->right);
+            emitArith(0x5e);
+            break;
+        case NT_MODULO:
+            compileBinary(static_cast<const CNModulo*>(node)->left, static_cast<const CNModulo*>(node)->right);
+            compileCall(reinterpret_cast<const void*>(static_cast<binary_type>(&std::fmod)));
+            break;
+        case NT_POWER:
+            compileBinary(static_cast<const CNPower*>(node)->left, static_cast<const CNPower*>(node)->right);
+            compileCall(reinterpret_cast<const void*>(static_cast<binary_type>(&std::pow)));
+            break;
+        case NT_BINARYFUNCTION:
+            compileBinary(static_cast<const CNBinaryFunction*>(node)->left, static_cast<const CNBinaryFunction*>(node)->right);
+            compileCall(reinterpret_cast<const void*>(static_cast<binary_type>(&std::pow)));
+            break;
+        case NT_COMPARE: {
+            const CNCompare* n = static_cast<const CNCompare*>(node);
+            compileBinary(n->left, n->right);
+            compileCompare(n->fn);
+            break;
+        }
+        case NT_UNARYFUNCTION: {
+            const CNUnaryFunction* n = static_cast<const CNUnaryFunction*>(node);
+            compileNode(n->left);
+            switch (n->fn) {
+                case UF_SQRT: {
+                    static const unsigned char sqrtsd[] = { 0xf2, 0x0f, 0x51, 0xc0 };
+                    emit(sqrtsd, sizeof(sqrtsd));   // sqrtsd xmm0, xmm0
+                    break;
+                }
+                case UF_EXP:
+                    compileCall(reinterpret_cast<const void*>(static_cast<unary_type>(&std::exp)));
+                    break;
+                case UF_LOG:
+                    compileCall(reinterpret_cast<const void*>(static_cast<unary_type>(&std::log)));
+                    break;
+            }
+            break;
+        }
+        case NT_ASSIGNMENT: {
+            const CNAssignment* n = static_cast<const CNAssignment*>(node);
+            compileNode(n->left);
+            loadSlotAddress(&calc.variables[n->slot]);
+            static const unsigned char movsd[] = { 0xf2, 0x0f, 0x11, 0x00 };
+            emit(movsd, sizeof(movsd));     // movsd [rax], xmm0
+            break;
+        }
+        case NT_SHARE: {
+            const CNShare* n = static_cast<const CNShare*>(node);
+            compileNode(n->node);
+            loadSlotAddress(&n->value);
+            static const unsigned char movsd[] = { 0xf2, 0x0f, 0x11, 0x00 };
+            emit(movsd, sizeof(movsd));     // movsd [rax], xmm0
+            break;
+        }
+        case NT_BLOCK: {
+            const CNBlock* n = static_cast<const CNBlock*>(node);
+            for (unsigned int i = 0; i < n->count; ++i)
+                compileNode(n->statements[i]);
+            break;
+        }
+        default:
+            break;
+    }
+}
@@ -0,0 +1,99 @@
+/**
+ * @file jit.h
+ * @brief x86-64 native code generator for arithmetic expressions
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#ifndef JIT_H
+#define JIT_H
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <map>
+#include "expression.h"
+
+/** native code of one expression. The top level statements are split into
+ * steps, runs of arithmetic statements become one native function each and
+ * the rest (UDF calls, print, if, function definitions) is left to the tree
+ * walker. */
+class JitProgram : public YxlangProgram {
+public:
+    /// native step, reads and writes variables through the slot array
+    typedef double (*function_type)(double* const* slots);
+
+    struct Step {
+        /// native code of the step, NULL if it is interpreted
+        function_type	function;
+        /// the node evaluated by the tree walker otherwise
+        const YxlangNode*	node;
+    };
+
+    std::vector<Step>	steps;
+    /// addresses of the variables in the context's variables
+    /// and the values of shared subexpressions
+    std::vector<double*>	slots;
+
+    JitProgram() : code(NULL), codesize(0) {
+    }
+
+    virtual ~JitProgram();
+
+    virtual double	run(YxlangContext &calc);
+
+private:
+    friend class JitCompiler;
+
+    void*	code;
+    size_t	codesize;
+};
+
+/** emits SSE2 scalar code for the arithmetic subset of the tree */
+class JitCompiler {
+public:
+    /** the program reads and writes the variables of calc */
+    static JitProgram* compile(YxlangContext &calc, const YxlangNode* node);
+
+    /** true if node only uses constants, variables, assignments, the
+     * arithmetic and compare operators and sqrt/exp/log/pow */
+    static bool	compilable(const YxlangNode* node);
+
+private:
+    JitCompiler(YxlangContext &_calc, JitProgram* _program) : calc(_calc), program(_program), depth(0), maxdepth(0) {
+    }
+
+    void	split(const YxlangNode* node, std::vector<const YxlangNode*> &out);
+    void	compileFunction(const std::vector<const YxlangNode*> &nodes);
+    void	compileNode(const YxlangNode* node);
+    void	compileBinary(const YxlangNode* left, const YxlangNode* right);
+    void	compileCompare(int fn);
+    void	compileCall(const void* function);
+    void	loadLeaf(const YxlangNode* node, int xmm);
+    void	loadConstant(double value, int xmm);
+    void	loadSlotAddress(double* slot);
+    double*	address(const YxlangNode* node);
+    void	emitArith(unsigned char opcode);
+
+    void	emit(unsigned char b) {
+        buffer.push_back(b);
+    }
+    void	emit(const unsigned char* bytes, size_t n) {
+        buffer.insert(buffer.end(), bytes, bytes + n);
+    }
+    void	emit32(int v);
+    void	emit64(const void* p);
+
+    static bool	leaf(const YxlangNode* node) {
+        return node->type() == NT_CONSTANT || node->type() == NT_VARIABLE || node->type() == NT_SHAREREF;
+    }
+
+    YxlangContext&	calc;
+    JitProgram*	program;
+    std::vector<unsigned char>	buffer;
+    std::map<const double*, int>	slotindex;
+    unsigned int	depth;
+    unsigned int	maxdepth;
+};
+
+#endif // JIT_H
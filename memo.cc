@@ -0,0 +1,109 @@
+/**
+ * @file memo.cc
+ * @brief result cache of pure user defined functions
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <stdint.h>
+#include <set>
+#include "memo.h"
+#include "expression.h"
+
+YxlangMemo::YxlangMemo(unsigned int _nparams, size_t _capacity) : hits(0), misses(0), nparams(_nparams),
+    index(_capacity, Hash(_nparams), Equal(_nparams)), keys(_capacity * _nparams), values(_capacity), marked(_capacity, 0), hand(0) {
+}
+
+size_t YxlangMemo::Hash::operator()(const double* args) const {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned int i = 0; i < n; ++i) {
+        uint64_t bits;
+        memcpy(&bits, &args[i], sizeof(bits));
+        h = (h ^ bits) * 1099511628211ULL;
+        h ^= h >> 29;
+    }
+    return static_cast<size_t>(h);
+}
+
+bool YxlangMemo::find(const double* args, double &value) {
+    index_type::const_iterator ii = index.find(args);
+    if (ii == index.end()) {
+        ++misses;
+        return false;
+    }
+    ++hits;
+    marked[ii->second] = 1;
+    value = values[ii->second];
+    return true;
+}
+
+void YxlangMemo::insert(const double* args, double value) {
+    /* a recursive call with the same arguments may have got here first */
+    index_type::const_iterator ii = index.find(args);
+    if (ii != index.end()) {
+        values[ii->second] = value;
+        return;
+    }
+
+    size_t entry = index.size();
+    if (entry == values.size()) {
+        while (marked[hand]) {
+            marked[hand] = 0;
+            hand = (hand + 1) % values.size();
+        }
+        entry = hand;
+        hand = (hand + 1) % values.size();
+        index.erase(keys.data() + entry * nparams);
+    }
+    double* key = keys.data() + entry * nparams;
+    memcpy(key, args, nparams * sizeof(double));
+    values[entry] = value;
+    marked[entry] = 0;
+    index.insert(std::make_pair(static_cast<const double*>(key), entry));
+}
+
+namespace {
+
+/** false if node, or a function it calls, has an effect or reads a global.
+ * Functions in seen are pure or still being looked at, a cycle of calls
+ * is pure if nothing on it is impure. */
+bool pureNode(const YxlangContext &calc, const YxlangNode* node, std::set<const CNCustomFunction*> &seen) {
+    if (!node)
+        return true;
+
+    switch (node->type()) {
+        case NT_VARIABLE:
+        case NT_ASSIGNMENT:
+        case NT_CUSTOMFUNCTION:
+            return false;
+        case NT_UNARYFUNCTION:
+            if (static_cast<const CNUnaryFunction*>(node)->fn == UF_PRINT)
+                return false;
+            break;
+        case NT_CALLUDF: {
+            const CNCustomFunction* callee = calc.getFunction(static_cast<const CNCallUDF*>(node)->symbol);
+            /* a later definition clears the memos, until then the call is 0 */
+            if (callee && seen.insert(callee).second && !pureNode(calc, callee->right, seen))
+                return false;
+            break;
+        }
+        default:
+            break;
+    }
+
+    YxlangNode::Children nodes(node);
+    unsigned int n = nodes.size();
+    for (unsigned int i = 0; i < n; ++i) {
+        if (!pureNode(calc, nodes[i], seen))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool YxlangMemo::pure(const YxlangContext &calc, const CNCustomFunction* func) {
+    std::set<const CNCustomFunction*> seen;
+    seen.insert(func);
+    return pureNode(calc, func->right, seen);
+}
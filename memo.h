@@ -0,0 +1,85 @@
+/**
+ * @file memo.h
+ * @brief result cache of pure user defined functions
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#ifndef MEMO_H
+#define MEMO_H
+
+#include <stddef.h>
+#include <string.h>
+#include <vector>
+#include <unordered_map>
+
+class YxlangContext;
+class CNCustomFunction;
+
+/** Results of one pure function by argument tuple, at most capacity of
+ * them. Arguments are compared bit by bit, so 0 and -0 are different
+ * tuples and a NaN matches the same NaN. When the cache is full a clock
+ * hand picks the entry to replace: it passes over entries hit since it
+ * last came by, clearing their mark, and takes the first unmarked one. */
+class YxlangMemo {
+public:
+    /// lookups that found the arguments
+    unsigned long	hits;
+    /// lookups that did not, each is followed by a run of the body
+    unsigned long	misses;
+
+    YxlangMemo(unsigned int _nparams, size_t _capacity);
+
+    /** true and the cached result in value if args, nparams values, are
+     * in the cache */
+    bool	find(const double* args, double &value);
+    /** cache value as the result of args, replacing an entry if full */
+    void	insert(const double* args, double value);
+
+    size_t size() const {
+        return index.size();
+    }
+    size_t capacity() const {
+        return values.size();
+    }
+
+    /** true if calling func can have no effect but its result, and the
+     * result depends on nothing but the arguments: the body reads and
+     * assigns no global variable, does not print, defines no function and
+     * only calls functions, as defined in calc now, that are pure too */
+    static bool	pure(const YxlangContext &calc, const CNCustomFunction* func);
+
+private:
+    YxlangMemo(const YxlangMemo &);
+    YxlangMemo& operator=(const YxlangMemo &);
+
+    /** hashes and compares the nparams doubles a key points to */
+    struct Hash {
+        unsigned int	n;
+        explicit Hash(unsigned int _n) : n(_n) {
+        }
+        size_t	operator()(const double* args) const;
+    };
+    struct Equal {
+        unsigned int	n;
+        explicit Equal(unsigned int _n) : n(_n) {
+        }
+        bool operator()(const double* a, const double* b) const {
+            return memcmp(a, b, n * sizeof(double)) == 0;
+        }
+    };
+    /// keys point into keys, lookups with a pointer to the caller's arguments
+    typedef std::unordered_map<const double*, size_t, Hash, Equal>	index_type;
+
+    unsigned int	nparams;
+    index_type	index;
+    /// arguments of entry i at nparams * i, allocated up front so keys stay put
+    std::vector<double>	keys;
+    std::vector<double>	values;
+    /// entry was hit since the hand last passed it
+    std::vector<char>	marked;
+    /// next entry the clock looks at
+    size_t	hand;
+};
+
+#endif // MEMO_H
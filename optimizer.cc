@@ -0,0 +1,390 @@
+/**
+ * @file optimizer.cc
+ * @brief constant folding and algebraic simplification of the parsed tree
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <cmath>
+#include "optimizer.h"
+
+namespace {
+
+bool constant(const YxlangNode* node, double &value) {
+    if (!node || node->type() != NT_CONSTANT)
+        return false;
+    value = static_cast<const CNConstant*>(node)->value;
+    return true;
+}
+
+bool constant(const YxlangNode* node) {
+    double value;
+    return constant(node, value);
+}
+
+unsigned int size(const YxlangNode* node) {
+    if (!node)
+        return 0;
+    YxlangNode::Children children(node);
+    unsigned int n = children.size();
+    unsigned int total = 1;
+    for (unsigned int i = 0; i < n; ++i)
+        total += size(children[i]);
+    return total;
+}
+
+} // namespace
+
+bool YxlangOptimizer::pure(const YxlangNode* node) {
+    if (!node)
+        return true;
+
+    switch (node->type()) {
+        case NT_ASSIGNMENT:
+        case NT_PARAMASSIGN:
+        case NT_CUSTOMFUNCTION:
+        case NT_CALLUDF:
+        case NT_SHARE:
+            return false;
+        case NT_UNARYFUNCTION:
+            if (static_cast<const CNUnaryFunction*>(node)->fn == UF_PRINT)
+                return false;
+            break;
+        default:
+            break;
+    }
+    YxlangNode::Children children(node);
+    unsigned int n = children.size();
+    for (unsigned int i = 0; i < n; ++i) {
+        if (!pure(children[i]))
+            return false;
+    }
+    return true;
+}
+
+bool YxlangOptimizer::equal(const YxlangNode* a, const YxlangNode* b) {
+    if (!a || !b)
+        return a == b;
+    if (a->type() != b->type())
+        return false;
+
+    switch (a->type()) {
+        case NT_CONSTANT: {
+            double x = static_cast<const CNConstant*>(a)->value;
+            double y = static_cast<const CNConstant*>(b)->value;
+            return x == y && std::signbit(x) == std::signbit(y);
+        }
+        case NT_VARIABLE:
+            return static_cast<const CNVariable*>(a)->symbol == static_cast<const CNVariable*>(b)->symbol;
+        case NT_PARAMETER:
+            return static_cast<const CNParameter*>(a)->index == static_cast<const CNParameter*>(b)->index;
+        case NT_COMPARE:
+            if (static_cast<const CNCompare*>(a)->fn != static_cast<const CNCompare*>(b)->fn)
+                return false;
+            break;
+        case NT_UNARYFUNCTION:
+            if (static_cast<const CNUnaryFunction*>(a)->fn != static_cast<const CNUnaryFunction*>(b)->fn)
+                return false;
+            break;
+        case NT_BINARYFUNCTION:
+            if (static_cast<const CNBinaryFunction*>(a)->fn != static_cast<const CNBinaryFunction*>(b)->fn)
+                return false;
+            break;
+        case NT_NEGATE:
+        case NT_ADD:
+        case NT_SUBTRACT:
+        case NT_MULTIPLY:
+        case NT_DIVIDE:
+        case NT_MODULO:
+        case NT_POWER:
+            break;
+        default:
+            return false;
+    }
+    YxlangNode::Children achildren(a);
+    YxlangNode::Children bchildren(b);
+    unsigned int n = achildren.size();
+    for (unsigned int i = 0; i < n; ++i) {
+        if (!equal(achildren[i], bchildren[i]))
+            return false;
+    }
+    return true;
+}
+
+YxlangNode* YxlangOptimizer::fold(const YxlangNode* node) {
+    return make(node->evaluate(calc));
+}
+
+YxlangNode* YxlangOptimizer::optimize(YxlangNode* node) {
+    if (!node)
+        return node;
+
+    YxlangNode::Children slots(node);
+    unsigned int n = slots.size();
+    for (unsigned int i = 0; i < n; ++i) {
+        *slots.slot(i) = optimize(slots[i]);
+    }
+
+    switch (node->type()) {
+        case NT_NEGATE: {
+            CNNegate* negate = static_cast<CNNegate*>(node);
+            if (constant(negate->node))
+                return fold(node);
+            /* -(-x) */
+            if (negate->node->type() == NT_NEGATE)
+                return static_cast<CNNegate*>(negate->node)->node;
+            return node;
+        }
+        case NT_ADD:
+            return optimizeAdd(static_cast<CNAdd*>(node));
+        case NT_SUBTRACT:
+            return optimizeSubtract(static_cast<CNSubtract*>(node));
+        case NT_MULTIPLY:
+            return optimizeMultiply(static_cast<CNMultiply*>(node));
+        case NT_DIVIDE:
+            return optimizeDivide(static_cast<CNDivide*>(node));
+        case NT_MODULO: {
+            CNModulo* modulo = static_cast<CNModulo*>(node);
+            if (constant(modulo->left) && constant(modulo->right))
+                return fold(node);
+            return node;
+        }
+        case NT_COMPARE: {
+            CNCompare* compare = static_cast<CNCompare*>(node);
+            if (constant(compare->left) && constant(compare->right))
+                return fold(node);
+            return node;
+        }
+        case NT_POWER: {
+            CNPower* power = static_cast<CNPower*>(node);
+            return optimizePower(node, power->left, power->right);
+        }
+        case NT_BINARYFUNCTION: {
+            CNBinaryFunction* function = static_cast<CNBinaryFunction*>(node);
+            return optimizePower(node, function->left, function->right);
+        }
+        case NT_UNARYFUNCTION: {
+            CNUnaryFunction* function = static_cast<CNUnaryFunction*>(node);
+            if (function->fn != UF_PRINT && constant(function->left))
+                return fold(node);
+            return node;
+        }
+        case NT_CONDITION:
+            return optimizeCondition(static_cast<CNCondition*>(node));
+        case NT_CUSTOMFUNCTION:
+            definitions[static_cast<CNCustomFunction*>(node)->symbol] = static_cast<CNCustomFunction*>(node);
+            return node;
+        case NT_CALLUDF:
+            return inlineCall(static_cast<CNCallUDF*>(node));
+        case NT_BLOCK: {
+            /* a statement without effect only matters for its value, so
+             * only the last one of those stays */
+            CNBlock* block = static_cast<CNBlock*>(node);
+            if (block->count == 0)
+                return node;
+            unsigned int kept = 0;
+            for (unsigned int i = 0; i + 1 < block->count; ++i) {
+                if (!pure(block->statements[i]))
+                    block->statements[kept++] = block->statements[i];
+            }
+            block->statements[kept++] = block->statements[block->count - 1];
+            block->count = kept;
+            return kept == 1 ? block->statements[0] : node;
+        }
+        default:
+            return node;
+    }
+}
+
+YxlangNode* YxlangOptimizer::optimizeAdd(CNAdd* n) {
+    double a, b;
+    bool ca = constant(n->left, a);
+    bool cb = constant(n->right, b);
+    if (ca && cb)
+        return fold(n);
+    /* x + -0 is x, x + 0 turns -0 into 0 */
+    if (cb && b == 0 && (std::signbit(b) || fast()))
+        return n->left;
+    if (ca && a == 0 && (std::signbit(a) || fast()))
+        return n->right;
+    return n;
+}
+
+YxlangNode* YxlangOptimizer::optimizeSubtract(CNSubtract* n) {
+    double a, b;
+    bool ca = constant(n->left, a);
+    bool cb = constant(n->right, b);
+    if (ca && cb)
+        return fold(n);
+    if (cb && b == 0 && (!std::signbit(b) || fast()))
+        return n->left;
+    /* -0 - x is -x, 0 - x differs for x = 0 */
+    if (ca && a == 0 && (std::signbit(a) || fast()))
+        return new (arena) CNNegate(n->right);
+    /* x - x is NaN for NaN and infinite x */
+    if (fast() && pure(n->left) && equal(n->left, n->right))
+        return make(0);
+    return n;
+}
+
+YxlangNode* YxlangOptimizer::optimizeMultiply(CNMultiply* n) {
+    double a, b;
+    bool ca = constant(n->left, a);
+    bool cb = constant(n->right, b);
+    if (ca && cb)
+        return fold(n);
+    if (cb && b == 1)
+        return n->left;
+    if (ca && a == 1)
+        return n->right;
+    /* negation flips the sign bit of a NaN, the multiply keeps it */
+    if (fast() && cb && b == -1)
+        return new (arena) CNNegate(n->left);
+    if (fast() && ca && a == -1)
+        return new (arena) CNNegate(n->right);
+    /* x * 0 is NaN for NaN and infinite x, -0 for negative x */
+    if (fast() && ((cb && b == 0 && pure(n->left)) || (ca && a == 0 && pure(n->right))))
+        return make(0);
+    return n;
+}
+
+YxlangNode* YxlangOptimizer::optimizeDivide(CNDivide* n) {
+    double a, b;
+    bool ca = constant(n->left, a);
+    bool cb = constant(n->right, b);
+    if (ca && cb)
+        return fold(n);
+    if (cb && b == 1)
+        return n->left;
+    if (fast() && cb && b == -1)
+        return new (arena) CNNegate(n->left);
+    return n;
+}
+
+YxlangNode* YxlangOptimizer::optimizePower(YxlangNode* node, YxlangNode* &left, YxlangNode* &right) {
+    double a, b;
+    bool ca = constant(left, a);
+    bool cb = constant(right, b);
+    if (ca && cb)
+        return fold(node);
+    if (!cb)
+        return node;
+    /* libm's pow(x, 1) clears the sign bit of a NaN x */
+    if (b == 1 && fast())
+        return left;
+    /* pow(x, 0) is 1 even for NaN */
+    if (b == 0 && pure(left))
+        return make(1);
+    /* x*x is exact, only worth it when x is cheap to read twice */
+    if (b == 2 && left->type() == NT_VARIABLE) {
+        CNVariable* x = static_cast<CNVariable*>(left);
+        return new (arena) CNMultiply(x, x->copy(arena));
+    }
+    if (b == 2 && left->type() == NT_PARAMETER) {
+        CNParameter* x = static_cast<CNParameter*>(left);
+        return new (arena) CNMultiply(x, new (arena) CNParameter(x->symbol, x->index));
+    }
+    /* sqrt differs from pow for -0 and -inf */
+    if (b == 0.5 && fast())
+        return new (arena) CNUnaryFunction(UF_SQRT, left);
+    return node;
+}
+
+YxlangNode* YxlangOptimizer::optimizeCondition(CNCondition* n) {
+    double c;
+    if (!constant(n->cond, c))
+        return n;
+    YxlangNode* taken = YxlangNode::truth(c) ? n->left : n->right;
+    return taken ? taken : new (arena) CNConstant(0);
+}
+
+YxlangNode* YxlangOptimizer::inlineCall(CNCallUDF* n) {
+    std::map<unsigned int, const CNCustomFunction*>::const_iterator di = definitions.find(n->symbol);
+    const CNCustomFunction* function = di != definitions.end() ? di->second : calc.getFunction(n->symbol);
+    if (!function || !function->right || !pure(function->right) || size(function->right) > INLINE_LIMIT)
+        return n;
+
+    /* a pure argument gives the same value wherever and however often
+     * the body reads it */
+    std::vector<const YxlangNode*> args;
+    for (CNCallUDF::Arguments a(n); !a.done(); a.next()) {
+        const YxlangNode* arg = a.node();
+        if (!pure(arg))
+            return n;
+        args.push_back(arg);
+    }
+
+    YxlangNode* body = substitute(function->right, &args);
+    if (!body)
+        return n;
+    return new (arena) CNCondition(new (arena) CNGuard(n->symbol, function->serial), optimize(body), n);
+}
+
+YxlangNode* YxlangOptimizer::substitute(const YxlangNode* node, const std::vector<const YxlangNode*>* args) {
+    if (!node)
+        return NULL;
+
+    if (node->type() == NT_PARAMETER) {
+        const CNParameter* parameter = static_cast<const CNParameter*>(node);
+        /* the parameters of an argument belong to the function making the call */
+        if (!args)
+            return new (arena) CNParameter(parameter->symbol, parameter->index);
+        return parameter->index < args->size() ? substitute((*args)[parameter->index], NULL) : make(0);
+    }
+
+    if (node->type() == NT_BLOCK) {
+        const CNBlock* block = static_cast<const CNBlock*>(node);
+        CNBlock* copy = new (arena) CNBlock(arena, block->count);
+        for (unsigned int i = 0; i < block->count; ++i) {
+            YxlangNode* statement = substitute(block->statements[i], args);
+            if (!statement)
+                return NULL;
+            copy->append(arena, statement);
+        }
+        return copy;
+    }
+
+    YxlangNode::Children children(node);
+    YxlangNode* copies[3] = { NULL, NULL, NULL };
+    unsigned int n = children.size();
+    for (unsigned int i = 0; i < n; ++i) {
+        copies[i] = substitute(children[i], args);
+        if (children[i] && !copies[i])
+            return NULL;
+    }
+
+    switch (node->type()) {
+        case NT_CONSTANT:
+            return make(static_cast<const CNConstant*>(node)->value);
+        case NT_VARIABLE:
+            return static_cast<const CNVariable*>(node)->copy(arena);
+        case NT_NEGATE:
+            return new (arena) CNNegate(copies[0]);
+        case NT_ADD:
+            return new (arena) CNAdd(copies[0], copies[1]);
+        case NT_SUBTRACT:
+            return new (arena) CNSubtract(copies[0], copies[1]);
+        case NT_MULTIPLY:
+            return new (arena) CNMultiply(copies[0], copies[1]);
+        case NT_DIVIDE:
+            return new (arena) CNDivide(copies[0], copies[1]);
+        case NT_MODULO:
+            return new (arena) CNModulo(copies[0], copies[1]);
+        case NT_POWER:
+            return new (arena) CNPower(copies[0], copies[1]);
+        case NT_COMPARE:
+            return new (arena) CNCompare(static_cast<const CNCompare*>(node)->fn, copies[0], copies[1]);
+        case NT_UNARYFUNCTION:
+            return new (arena) CNUnaryFunction(static_cast<const CNUnaryFunction*>(node)->fn, copies[0]);
+        case NT_BINARYFUNCTION:
+            return new (arena) CNBinaryFunction(static_cast<const CNBinaryFunction*>(node)->fn, copies[0], copies[1]);
+        case NT_CONDITION:
+            return new (arena) CNCondition(copies[0], copies[1], copies[2]);
+        case NT_GUARD: {
+            const CNGuard* guard = static_cast<const CNGuard*>(node);
+            return new (arena) CNGuard(guard->symbol, guard->serial);
+        }
+        default:
+            return NULL;
+    }
+}
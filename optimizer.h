@@ -0,0 +1,85 @@
+/**
+ * @file optimizer.h
+ * @brief constant folding and algebraic simplification of the parsed tree
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <map>
+#include <vector>
+#include "expression.h"
+
+/** optimization levels */
+enum YxlangOptimizeLevel {
+    OPTIMIZE_NONE,
+    /// fold constants, apply identities that give bit-identical results
+    OPTIMIZE_SAFE,
+    /// also apply identities that differ for NaN, infinities or signed zero,
+    /// such as x-x -> 0, x*0 -> 0, x+0 -> x and pow(x,0.5) -> sqrt(x)
+    OPTIMIZE_FAST
+};
+
+/** rewrites a tree in place. Constant subtrees are folded by evaluating
+ * them, so they give exactly what the tree walker would. Subtrees that
+ * print or call a UDF are never dropped, duplicated or merged.
+ *
+ * Calls of small functions whose body has no effect are inlined when the
+ * arguments have none either: the body is copied with the parameters
+ * replaced by the argument expressions, and folded again. The copy runs
+ * under a CNGuard, the original call is kept for when the function has
+ * been redefined by then. A body that calls a UDF is not inlined, so
+ * neither is a recursive function. */
+class YxlangOptimizer {
+public:
+    /** new nodes come from the current arena of calc, constants are
+     * folded in it */
+    explicit YxlangOptimizer(YxlangContext &_calc, YxlangOptimizeLevel _level = OPTIMIZE_SAFE) : calc(_calc), arena(_calc.getArena()), level(_level) {
+    }
+
+    /** returns the node to use instead of node. New nodes come from arena,
+     * nodes that are no longer used stay there until it is released. */
+    YxlangNode*	optimize(YxlangNode* node);
+
+    /** true if evaluating node has no effect besides its value */
+    static bool	pure(const YxlangNode* node);
+    /** true if both trees are built the same */
+    static bool	equal(const YxlangNode* a, const YxlangNode* b);
+
+private:
+    YxlangNode*	optimizeAdd(CNAdd* n);
+    YxlangNode*	optimizeSubtract(CNSubtract* n);
+    YxlangNode*	optimizeMultiply(CNMultiply* n);
+    YxlangNode*	optimizeDivide(CNDivide* n);
+    YxlangNode*	optimizePower(YxlangNode* node, YxlangNode* &left, YxlangNode* &right);
+    YxlangNode*	optimizeCondition(CNCondition* n);
+    YxlangNode*	inlineCall(CNCallUDF* n);
+    /** copy of node with parameter i replaced by a copy of args[i], 0 if
+     * there is no such argument, or a plain copy if args is NULL. NULL if
+     * node holds something the copy does not handle. */
+    YxlangNode*	substitute(const YxlangNode* node, const std::vector<const YxlangNode*>* args);
+
+    /** replace a subtree built from constants with its value */
+    YxlangNode*	fold(const YxlangNode* node);
+    YxlangNode*	make(double value) {
+        return new (arena) CNConstant(value);
+    }
+
+    bool	fast() const {
+        return level >= OPTIMIZE_FAST;
+    }
+
+    /// largest body inlined, in nodes
+    enum { INLINE_LIMIT = 32 };
+
+    YxlangContext&	calc;
+    YxlangArena&	arena;
+    YxlangOptimizeLevel	level;
+    /// function definitions met so far, in evaluation order, the calls
+    /// after them most likely run them
+    std::map<unsigned int, const CNCustomFunction*>	definitions;
+};
+
+#endif // OPTIMIZER_H
@@ -0,0 +1,143 @@
+/**
+ * @file parsecache.cc
+ * @brief parsed expressions by source text
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <map>
+#include "parsecache.h"
+#include "expression.h"
+#include "optimizer.h"
+
+namespace {
+
+/** functions node calls, with those their bodies call, as defined now */
+void collect(const YxlangContext &calc, const YxlangNode* node, std::map<unsigned int, const CNCustomFunction*> &callees) {
+    if (!node)
+        return;
+
+    unsigned int symbol = 0;
+    bool calls = false;
+    if (node->type() == NT_CALLUDF) {
+        symbol = static_cast<const CNCallUDF*>(node)->symbol;
+        calls = true;
+    } else if (node->type() == NT_GUARD) {
+        symbol = static_cast<const CNGuard*>(node)->symbol;
+        calls = true;
+    }
+    if (calls && callees.find(symbol) == callees.end()) {
+        const CNCustomFunction* callee = calc.getFunction(symbol);
+        callees[symbol] = callee;
+        if (callee)
+            collect(calc, callee->right, callees);
+    }
+
+    YxlangNode::Children children(node);
+    unsigned int n = children.size();
+    for (unsigned int i = 0; i < n; ++i)
+        collect(calc, children[i], callees);
+}
+
+} // namespace
+
+YxlangParseCache::YxlangParseCache(size_t _capacity) : hits(0), misses(0), stale(0), maxsize(_capacity) {
+}
+
+YxlangParseCache::~YxlangParseCache() {
+    for (list_type::iterator ei = entries.begin(); ei != entries.end(); ++ei) {
+        delete ei->arena;
+    }
+    for (size_t i = 0; i < retired.size(); ++i) {
+        delete retired[i].first;
+    }
+}
+
+bool YxlangParseCache::find(YxlangContext &calc, const std::string &text, int level) {
+    sweep(calc);
+
+    std::unordered_map<std::string, list_type::iterator>::iterator ii = index.find(text);
+    if (ii == index.end()) {
+        ++misses;
+        return false;
+    }
+    list_type::iterator entry = ii->second;
+    if (!current(calc, *entry, level)) {
+        ++stale;
+        ++misses;
+        retire(entry);
+        return false;
+    }
+
+    ++hits;
+    entries.splice(entries.begin(), entries, entry);
+    entry->generation = calc.generation;
+    calc.expressions.insert(calc.expressions.end(), entry->expressions.begin(), entry->expressions.end());
+    return true;
+}
+
+void YxlangParseCache::insert(YxlangContext &calc, const std::string &text, int level, YxlangArena* arena, size_t first) {
+    std::unordered_map<std::string, list_type::iterator>::iterator ii = index.find(text);
+    if (ii != index.end())
+        retire(ii->second);
+    while (!entries.empty() && entries.size() >= maxsize)
+        retire(--entries.end());
+    if (maxsize == 0) {
+        retired.push_back(std::make_pair(arena, calc.generation));
+        return;
+    }
+
+    entries.push_front(Entry());
+    Entry &entry = entries.front();
+    entry.text = text;
+    entry.level = level;
+    entry.arena = arena;
+    entry.expressions.assign(calc.expressions.begin() + first, calc.expressions.end());
+    if (level != OPTIMIZE_NONE) {
+        std::map<unsigned int, const CNCustomFunction*> callees;
+        for (size_t i = 0; i < entry.expressions.size(); ++i)
+            collect(calc, entry.expressions[i], callees);
+        for (std::map<unsigned int, const CNCustomFunction*>::const_iterator ci = callees.begin(); ci != callees.end(); ++ci)
+            entry.callees.push_back(std::make_pair(ci->first, ci->second ? ci->second->serial : 0UL));
+    }
+    entry.definitions = calc.definitions;
+    entry.generation = calc.generation;
+    index[text] = entries.begin();
+}
+
+void YxlangParseCache::resize(size_t _capacity) {
+    maxsize = _capacity;
+    while (entries.size() > maxsize)
+        retire(--entries.end());
+}
+
+bool YxlangParseCache::current(const YxlangContext &calc, Entry &entry, int level) const {
+    if (entry.level != level)
+        return false;
+    if (entry.definitions == calc.definitions)
+        return true;
+    for (size_t i = 0; i < entry.callees.size(); ++i) {
+        const CNCustomFunction* callee = calc.getFunction(entry.callees[i].first);
+        if ((callee ? callee->serial : 0UL) != entry.callees[i].second)
+            return false;
+    }
+    entry.definitions = calc.definitions;
+    return true;
+}
+
+void YxlangParseCache::retire(list_type::iterator entry) {
+    retired.push_back(std::make_pair(entry->arena, entry->generation));
+    index.erase(entry->text);
+    entries.erase(entry);
+}
+
+void YxlangParseCache::sweep(const YxlangContext &calc) {
+    size_t kept = 0;
+    for (size_t i = 0; i < retired.size(); ++i) {
+        if (retired[i].second == calc.generation)
+            retired[kept++] = retired[i];
+        else
+            delete retired[i].first;
+    }
+    retired.resize(kept);
+}
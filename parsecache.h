@@ -0,0 +1,93 @@
+/**
+ * @file parsecache.h
+ * @brief parsed expressions by source text
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#ifndef PARSECACHE_H
+#define PARSECACHE_H
+
+#include <stddef.h>
+#include <string>
+#include <list>
+#include <vector>
+#include <unordered_map>
+
+class YxlangContext;
+class YxlangArena;
+class YxlangNode;
+class CNCustomFunction;
+
+/** The expressions parsed, and optimized, from a source text, for the
+ * last capacity texts of one context. Each entry owns the arena its nodes
+ * came from, a lookup hands out the same nodes again. The least recently
+ * used entry is replaced when the cache is full, its arena is freed once
+ * the context has cleared its expressions, as they may hold its nodes.
+ *
+ * Unoptimized nodes call functions by name, so they hold whatever the
+ * functions are. Optimized ones may have the bodies of some inlined, an
+ * entry records the functions it calls, also through their bodies, and is
+ * parsed again once one of them is redefined. Texts defining a function
+ * are not cached, the definition has to live as long as the context. */
+class YxlangParseCache {
+public:
+    /// lookups that found the text
+    unsigned long	hits;
+    /// lookups that did not, each is followed by a parse
+    unsigned long	misses;
+    /// lookups that found the text parsed with other functions or another
+    /// optimization level, counted as misses too
+    unsigned long	stale;
+
+    explicit YxlangParseCache(size_t _capacity);
+    ~YxlangParseCache();
+
+    /** append the expressions of text to calc.expressions and return true
+     * if it is cached for level and the functions it calls now */
+    bool	find(YxlangContext &calc, const std::string &text, int level);
+    /** cache calc.expressions from first on as the parse of text at level,
+     * their nodes are all in arena, which the cache takes over */
+    void	insert(YxlangContext &calc, const std::string &text, int level, YxlangArena* arena, size_t first);
+    /** keep at most _capacity entries, dropping the least recently used */
+    void	resize(size_t _capacity);
+
+    size_t size() const {
+        return index.size();
+    }
+    size_t capacity() const {
+        return maxsize;
+    }
+
+private:
+    YxlangParseCache(const YxlangParseCache &);
+    YxlangParseCache& operator=(const YxlangParseCache &);
+
+    struct Entry {
+        std::string	text;
+        int	level;
+        YxlangArena*	arena;
+        std::vector<YxlangNode*>	expressions;
+        /// functions called when optimized, with the serial of their
+        /// definition then, 0 if there was none
+        std::vector<std::pair<unsigned int, unsigned long> >	callees;
+        /// calc.definitions when callees were last found current
+        unsigned long	definitions;
+        /// calc.generation when last handed out
+        unsigned long	generation;
+    };
+    typedef std::list<Entry>	list_type;
+    /// most recently used first
+    list_type	entries;
+    std::unordered_map<std::string, list_type::iterator>	index;
+    size_t	maxsize;
+    /// arenas of dropped entries with the generation they were last
+    /// handed out in, freed once the context is past it
+    std::vector<std::pair<YxlangArena*, unsigned long> >	retired;
+
+    bool	current(const YxlangContext &calc, Entry &entry, int level) const;
+    void	retire(list_type::iterator entry);
+    void	sweep(const YxlangContext &calc);
+};
+
+#endif // PARSECACHE_H
@@ -1,4 +1,4 @@
-// A Bison parser, made by GNU Bison 3.8.
+// A Bison parser, made by GNU Bison 3.8.2.
 
 // Skeleton implementation for Bison LALR(1) parsers in C++
 
@@ -55,7 +55,7 @@
 #include "parser.h"
 
 // Second part of user prologue.
-#line 88 "parser.yy"
+#line 86 "parser.yy"
 
 
 #include "driver.h"
@@ -180,9 +180,9 @@ namespace yxlang {
   Parser::syntax_error::~syntax_error () YY_NOEXCEPT YY_NOTHROW
   {}
 
-  /*---------------.
-  | symbol kinds.  |
-  `---------------*/
+  /*---------.
+  | symbol.  |
+  `---------*/
 
   // basic_symbol.
   template <typename Base>
@@ -208,6 +208,7 @@ namespace yxlang {
     , location (YY_MOVE (l))
   {}
 
+
   template <typename Base>
   Parser::symbol_kind_type
   Parser::basic_symbol<Base>::type_get () const YY_NOEXCEPT
@@ -215,6 +216,7 @@ namespace yxlang {
     return this->kind ();
   }
 
+
   template <typename Base>
   bool
   Parser::basic_symbol<Base>::empty () const YY_NOEXCEPT
@@ -232,26 +234,28 @@ namespace yxlang {
   }
 
   // by_kind.
-  Parser::by_kind::by_kind ()
+  Parser::by_kind::by_kind () YY_NOEXCEPT
     : kind_ (symbol_kind::S_YYEMPTY)
   {}
 
 #if 201103L <= YY_CPLUSPLUS
-  Parser::by_kind::by_kind (by_kind&& that)
+  Parser::by_kind::by_kind (by_kind&& that) YY_NOEXCEPT
     : kind_ (that.kind_)
   {
     that.clear ();
   }
 #endif
 
-  Parser::by_kind::by_kind (const by_kind& that)
+  Parser::by_kind::by_kind (const by_kind& that) YY_NOEXCEPT
     : kind_ (that.kind_)
   {}
 
-  Parser::by_kind::by_kind (token_kind_type t)
+  Parser::by_kind::by_kind (token_kind_type t) YY_NOEXCEPT
     : kind_ (yytranslate_ (t))
   {}
 
+
+
   void
   Parser::by_kind::clear () YY_NOEXCEPT
   {
@@ -271,6 +275,7 @@ namespace yxlang {
     return kind_;
   }
 
+
   Parser::symbol_kind_type
   Parser::by_kind::type_get () const YY_NOEXCEPT
   {
@@ -278,6 +283,7 @@ namespace yxlang {
   }
 
 
+
   // by_state.
   Parser::by_state::by_state () YY_NOEXCEPT
     : state (empty_state)
@@ -362,83 +368,7 @@ namespace yxlang {
       YY_SYMBOL_PRINT (yymsg, yysym);
 
     // User destructor.
-    switch (yysym.kind ())
-    {
-      case symbol_kind::S_STRING: // "string"
-#line 77 "parser.yy"
-                    { delete (yysym.value.stringVal); }
-#line 371 "parser.cc"
-        break;
-
-      case symbol_kind::S_constant: // constant
-#line 78 "parser.yy"
-                    { delete (yysym.value.yxlangnode); }
-#line 377 "parser.cc"
-        break;
-
-      case symbol_kind::S_variable: // variable
-#line 78 "parser.yy"
-                    { delete (yysym.value.yxlangnode); }
-#line 383 "parser.cc"
-        break;
-
-      case symbol_kind::S_atomexpr: // atomexpr
-#line 79 "parser.yy"
-                    { delete (yysym.value.yxlangnode); }
-#line 389 "parser.cc"
-        break;
-
-      case symbol_kind::S_expr: // expr
-#line 79 "parser.yy"
-                    { delete (yysym.value.yxlangnode); }
-#line 395 "parser.cc"
-        break;
-
-      case symbol_kind::S_exprlist: // exprlist
-#line 79 "parser.yy"
-                    { delete (yysym.value.yxlangnode); }
-#line 401 "parser.cc"
-        break;
-
-      case symbol_kind::S_assignment: // assignment
-#line 79 "parser.yy"
-                    { delete (yysym.value.yxlangnode); }
-#line 407 "parser.cc"
-        break;
-
-      case symbol_kind::S_ifstmt: // ifstmt
-#line 79 "parser.yy"
-                    { delete (yysym.value.yxlangnode); }
-#line 413 "parser.cc"
-        break;
-
-      case symbol_kind::S_funcstmt: // funcstmt
-#line 79 "parser.yy"
-                    { delete (yysym.value.yxlangnode); }
-#line 419 "parser.cc"
-        break;
-
-      case symbol_kind::S_stmt: // stmt
-#line 79 "parser.yy"
-                    { delete (yysym.value.yxlangnode); }
-#line 425 "parser.cc"
-        break;
-
-      case symbol_kind::S_sentencelist: // sentencelist
-#line 79 "parser.yy"
-                    { delete (yysym.value.yxlangnode); }
-#line 431 "parser.cc"
-        break;
-
-      case symbol_kind::S_stmtlist: // stmtlist
-#line 79 "parser.yy"
-                    { delete (yysym.value.yxlangnode); }
-#line 437 "parser.cc"
-        break;
-
-      default:
-        break;
-    }
+    YY_USE (yysym.kind ());
   }
 
 #if YXLANGDEBUG
@@ -482,7 +412,7 @@ namespace yxlang {
   }
 
   void
-  Parser::yypop_ (int n)
+  Parser::yypop_ (int n) YY_NOEXCEPT
   {
     yystack_.pop (n);
   }
@@ -525,13 +455,13 @@ namespace yxlang {
   }
 
   bool
-  Parser::yy_pact_value_is_default_ (int yyvalue)
+  Parser::yy_pact_value_is_default_ (int yyvalue) YY_NOEXCEPT
   {
     return yyvalue == yypact_ninf_;
   }
 
   bool
-  Parser::yy_table_value_is_error_ (int yyvalue)
+  Parser::yy_table_value_is_error_ (int yyvalue) YY_NOEXCEPT
   {
     return yyvalue == yytable_ninf_;
   }
@@ -576,7 +506,7 @@ namespace yxlang {
     yyla.location.begin.filename = yyla.location.end.filename = &driver.streamname;
 }
 
-#line 580 "parser.cc"
+#line 510 "parser.cc"
 
 
     /* Initialize the stack.  The initial state will be set in
@@ -712,275 +642,272 @@ namespace yxlang {
           switch (yyn)
             {
   case 2: // constant: "integer"
-#line 105 "parser.yy"
+#line 103 "parser.yy"
                    {
-	       (yylhs.value.yxlangnode) = new CNConstant((yystack_[0].value.integerVal));
+	       (yylhs.value.yxlangnode) = new (driver.calc.getArena()) CNConstant((yystack_[0].value.integerVal));
 	     }
-#line 720 "parser.cc"
+#line 650 "parser.cc"
     break;
 
   case 3: // constant: "double"
-#line 108 "parser.yy"
+#line 106 "parser.yy"
                   {
-	       (yylhs.value.yxlangnode) = new CNConstant((yystack_[0].value.doubleVal));
+	       (yylhs.value.yxlangnode) = new (driver.calc.getArena()) CNConstant((yystack_[0].value.doubleVal));
 	     }
-#line 728 "parser.cc"
+#line 658 "parser.cc"
     break;
 
   case 4: // variable: "string"
-#line 112 "parser.yy"
+#line 110 "parser.yy"
                   {
-           (yylhs.value.yxlangnode) = new CNVariable((yystack_[0].value.stringVal));
+           (yylhs.value.yxlangnode) = new (driver.calc.getArena()) CNVariable((yystack_[0].value.symbolVal));
 	     }
-#line 736 "parser.cc"
+#line 666 "parser.cc"
     break;
 
   case 5: // atomexpr: constant
-#line 116 "parser.yy"
+#line 114 "parser.yy"
                     {
 	       (yylhs.value.yxlangnode) = (yystack_[0].value.yxlangnode);
 	     }
-#line 744 "parser.cc"
+#line 674 "parser.cc"
     break;
 
   case 6: // atomexpr: variable
-#line 119 "parser.yy"
+#line 117 "parser.yy"
                     {
 	       (yylhs.value.yxlangnode) = (yystack_[0].value.yxlangnode);
 	     }
-#line 752 "parser.cc"
+#line 682 "parser.cc"
     break;
 
   case 7: // atomexpr: '(' expr ')'
-#line 122 "parser.yy"
+#line 120 "parser.yy"
                         {
 	       (yylhs.value.yxlangnode) = (yystack_[1].value.yxlangnode);
 	     }
-#line 760 "parser.cc"
+#line 690 "parser.cc"
     break;
 
   case 8: // expr: expr '+' expr
-#line 126 "parser.yy"
+#line 124 "parser.yy"
                      {
-	   (yylhs.value.yxlangnode) = new CNAdd((yystack_[2].value.yxlangnode), (yystack_[0].value.yxlangnode));
+	   (yylhs.value.yxlangnode) = new (driver.calc.getArena()) CNAdd((yystack_[2].value.yxlangnode), (yystack_[0].value.yxlangnode));
      }
-#line 768 "parser.cc"
+#line 698 "parser.cc"
     break;
 
   case 9: // expr: expr '-' expr
-#line 129 "parser.yy"
+#line 127 "parser.yy"
                      {
-	   (yylhs.value.yxlangnode) = new CNSubtract((yystack_[2].value.yxlangnode), (yystack_[0].value.yxlangnode));
+	   (yylhs.value.yxlangnode) = new (driver.calc.getArena()) CNSubtract((yystack_[2].value.yxlangnode), (yystack_[0].value.yxlangnode));
      }
-#line 776 "parser.cc"
+#line 706 "parser.cc"
     break;
 
   case 10: // expr: expr '*' expr
-#line 132 "parser.yy"
+#line 130 "parser.yy"
                      {
-	   (yylhs.value.yxlangnode) = new CNMultiply((yystack_[2].value.yxlangnode), (yystack_[0].value.yxlangnode));
+	   (yylhs.value.yxlangnode) = new (driver.calc.getArena()) CNMultiply((yystack_[2].value.yxlangnode), (yystack_[0].value.yxlangnode));
      }
-#line 784 "parser.cc"
+#line 714 "parser.cc"
     break;
 
   case 11: // expr: expr '/' expr
-#line 135 "parser.yy"
+#line 133 "parser.yy"
                      {
-	   (yylhs.value.yxlangnode) = new CNDivide((yystack_[2].value.yxlangnode), (yystack_[0].value.yxlangnode));
+	   (yylhs.value.yxlangnode) = new (driver.calc.getArena()) CNDivide((yystack_[2].value.yxlangnode), (yystack_[0].value.yxlangnode));
      }
-#line 792 "parser.cc"
+#line 722 "parser.cc"
     break;
 
   case 12: // expr: expr '%' expr
-#line 138 "parser.yy"
+#line 136 "parser.yy"
                      {
-	   (yylhs.value.yxlangnode) = new CNModulo((yystack_[2].value.yxlangnode), (yystack_[0].value.yxlangnode));
+	   (yylhs.value.yxlangnode) = new (driver.calc.getArena()) CNModulo((yystack_[2].value.yxlangnode), (yystack_[0].value.yxlangnode));
      }
-#line 800 "parser.cc"
+#line 730 "parser.cc"
     break;
 
   case 13: // expr: expr CMP expr
-#line 141 "parser.yy"
+#line 139 "parser.yy"
                      {
-	   (yylhs.value.yxlangnode) = new CNCompare((yystack_[1].value.fn), (yystack_[2].value.yxlangnode), (yystack_[0].value.yxlangnode));
+	   (yylhs.value.yxlangnode) = new (driver.calc.getArena()) CNCompare((yystack_[1].value.fn), (yystack_[2].value.yxlangnode), (yystack_[0].value.yxlangnode));
      }
-#line 808 "parser.cc"
+#line 738 "parser.cc"
     break;
 
   case 14: // expr: UNARYFUNC '(' expr ')'
-#line 144 "parser.yy"
+#line 142 "parser.yy"
                               {
-	   (yylhs.value.yxlangnode) = new CNUnaryFunction((yystack_[3].value.fn), (yystack_[1].value.yxlangnode));
+	   (yylhs.value.yxlangnode) = new (driver.calc.getArena()) CNUnaryFunction((yystack_[3].value.fn), (yystack_[1].value.yxlangnode));
      }
-#line 816 "parser.cc"
+#line 746 "parser.cc"
     break;
 
   case 15: // expr: BINARYFUNC '(' expr ',' expr ')'
-#line 147 "parser.yy"
+#line 145 "parser.yy"
                                         {
-	   (yylhs.value.yxlangnode) = new CNBinaryFunction((yystack_[5].value.fn), (yystack_[3].value.yxlangnode), (yystack_[1].value.yxlangnode));
+	   (yylhs.value.yxlangnode) = new (driver.calc.getArena()) CNBinaryFunction((yystack_[5].value.fn), (yystack_[3].value.yxlangnode), (yystack_[1].value.yxlangnode));
      }
-#line 824 "parser.cc"
+#line 754 "parser.cc"
     break;
 
   case 16: // expr: "string" '(' exprlist ')'
-#line 150 "parser.yy"
+#line 148 "parser.yy"
                                {
-	   (yylhs.value.yxlangnode) = new CNCallUDF((yystack_[3].value.stringVal), (yystack_[1].value.yxlangnode));
+	   (yylhs.value.yxlangnode) = new (driver.calc.getArena()) CNCallUDF((yystack_[3].value.symbolVal), (yystack_[1].value.yxlangnode));
      }
-#line 832 "parser.cc"
+#line 762 "parser.cc"
     break;
 
   case 17: // expr: atomexpr
-#line 153 "parser.yy"
+#line 151 "parser.yy"
        { (yylhs.value.yxlangnode) = (yystack_[0].value.yxlangnode); }
-#line 838 "parser.cc"
+#line 768 "parser.cc"
     break;
 
   case 18: // exprlist: expr
-#line 155 "parser.yy"
+#line 153 "parser.yy"
                 {
-           (yylhs.value.yxlangnode) = new CNExprlist((yystack_[0].value.yxlangnode), NULL);
+           (yylhs.value.yxlangnode) = new (driver.calc.getArena()) CNExprlist((yystack_[0].value.yxlangnode), NULL);
          }
-#line 846 "parser.cc"
+#line 776 "parser.cc"
     break;
 
   case 19: // exprlist: expr ',' exprlist
-#line 158 "parser.yy"
+#line 156 "parser.yy"
                              {
-           (yylhs.value.yxlangnode) = new CNExprlist((yystack_[2].value.yxlangnode), (yystack_[0].value.yxlangnode));
+           (yylhs.value.yxlangnode) = new (driver.calc.getArena()) CNExprlist((yystack_[2].value.yxlangnode), (yystack_[0].value.yxlangnode));
          }
-#line 854 "parser.cc"
+#line 784 "parser.cc"
     break;
 
   case 20: // assignment: "string" '=' expr
-#line 162 "parser.yy"
+#line 160 "parser.yy"
                              {
-           (yylhs.value.yxlangnode) = new CNAssignment((yystack_[2].value.stringVal), (yystack_[0].value.yxlangnode));
+           (yylhs.value.yxlangnode) = new (driver.calc.getArena()) CNAssignment((yystack_[2].value.symbolVal), (yystack_[0].value.yxlangnode));
 	     }
-#line 862 "parser.cc"
+#line 792 "parser.cc"
     break;
 
   case 21: // ifstmt: IF expr THEN sentencelist FI
-#line 166 "parser.yy"
+#line 164 "parser.yy"
                                        {
-         (yylhs.value.yxlangnode) = new CNCondition((yystack_[3].value.yxlangnode), (yystack_[1].value.yxlangnode), NULL);
+         (yylhs.value.yxlangnode) = new (driver.calc.getArena()) CNCondition((yystack_[3].value.yxlangnode), (yystack_[1].value.yxlangnode), NULL);
        }
-#line 870 "parser.cc"
+#line 800 "parser.cc"
     break;
 
   case 22: // ifstmt: IF expr THEN sentencelist ELSE sentencelist FI
-#line 169 "parser.yy"
+#line 167 "parser.yy"
                                                         {
-         (yylhs.value.yxlangnode) = new CNCondition((yystack_[5].value.yxlangnode), (yystack_[3].value.yxlangnode), (yystack_[1].value.yxlangnode));
+         (yylhs.value.yxlangnode) = new (driver.calc.getArena()) CNCondition((yystack_[5].value.yxlangnode), (yystack_[3].value.yxlangnode), (yystack_[1].value.yxlangnode));
        }
-#line 878 "parser.cc"
+#line 808 "parser.cc"
     break;
 
   case 23: // funcstmt: LET "string" '(' paramlist ')' '=' sentencelist
-#line 173 "parser.yy"
+#line 171 "parser.yy"
                                                          {
-           (yylhs.value.yxlangnode) = new CNCustomFunction((yystack_[5].value.stringVal), (yystack_[3].value.yxlangnode), (yystack_[0].value.yxlangnode));
+           CNCustomFunction* function = new (driver.calc.getArena()) CNCustomFunction((yystack_[5].value.symbolVal), (yystack_[3].value.yxlangnode), (yystack_[0].value.yxlangnode));
+           function->resolve(driver.calc.getArena());
+           function->serial = ++driver.calc.serials;
+           function->arena = &driver.calc.getArena();
+           (yylhs.value.yxlangnode) = function;
+           /* the definition outlives the expressions of this parse */
+           driver.calc.getArena().pin();
          }
-#line 886 "parser.cc"
+#line 822 "parser.cc"
     break;
 
   case 24: // paramlist: "string"
-#line 177 "parser.yy"
+#line 181 "parser.yy"
                    {
-            (yylhs.value.yxlangnode) = new CNParamlist((yystack_[0].value.stringVal), NULL);
+            (yylhs.value.yxlangnode) = new (driver.calc.getArena()) CNParamlist((yystack_[0].value.symbolVal), NULL);
           }
-#line 894 "parser.cc"
+#line 830 "parser.cc"
     break;
 
   case 25: // paramlist: "string" ',' paramlist
-#line 180 "parser.yy"
+#line 184 "parser.yy"
                                  {
-            (yylhs.value.yxlangnode) = new CNParamlist((yystack_[2].value.stringVal), (yystack_[0].value.yxlangnode));
+            (yylhs.value.yxlangnode) = new (driver.calc.getArena()) CNParamlist((yystack_[2].value.symbolVal), (yystack_[0].value.yxlangnode));
           }
-#line 902 "parser.cc"
+#line 838 "parser.cc"
     break;
 
   case 26: // stmt: expr
-#line 184 "parser.yy"
+#line 188 "parser.yy"
          { (yylhs.value.yxlangnode) = (yystack_[0].value.yxlangnode); }
-#line 908 "parser.cc"
+#line 844 "parser.cc"
     break;
 
   case 27: // stmt: ifstmt
-#line 185 "parser.yy"
+#line 189 "parser.yy"
          { (yylhs.value.yxlangnode) = (yystack_[0].value.yxlangnode); }
-#line 914 "parser.cc"
+#line 850 "parser.cc"
     break;
 
   case 28: // stmt: assignment
-#line 186 "parser.yy"
+#line 190 "parser.yy"
          { (yylhs.value.yxlangnode) = (yystack_[0].value.yxlangnode); }
-#line 920 "parser.cc"
+#line 856 "parser.cc"
     break;
 
   case 29: // stmt: funcstmt
-#line 187 "parser.yy"
+#line 191 "parser.yy"
          { (yylhs.value.yxlangnode) = (yystack_[0].value.yxlangnode); }
-#line 926 "parser.cc"
+#line 862 "parser.cc"
     break;
 
   case 30: // sentencelist: %empty
-#line 189 "parser.yy"
+#line 193 "parser.yy"
                { (yylhs.value.yxlangnode) = NULL; }
-#line 932 "parser.cc"
+#line 868 "parser.cc"
     break;
 
-  case 31: // sentencelist: stmt ';' sentencelist
-#line 190 "parser.yy"
+  case 31: // sentencelist: sentencelist stmt ';'
+#line 194 "parser.yy"
                                  {
-           if ((yystack_[0].value.yxlangnode) == NULL) {
-             (yylhs.value.yxlangnode) = (yystack_[2].value.yxlangnode);
-           } else {
-             (yylhs.value.yxlangnode) = new CNStatement((yystack_[2].value.yxlangnode), (yystack_[0].value.yxlangnode));
-           }
+           (yylhs.value.yxlangnode) = CNBlock::join(driver.calc.getArena(), (yystack_[2].value.yxlangnode), (yystack_[1].value.yxlangnode));
          }
-#line 944 "parser.cc"
+#line 876 "parser.cc"
     break;
 
   case 32: // stmtlist: %empty
-#line 198 "parser.yy"
+#line 201 "parser.yy"
            { (yylhs.value.yxlangnode) = NULL; }
-#line 950 "parser.cc"
+#line 882 "parser.cc"
     break;
 
-  case 33: // stmtlist: stmt "end of line" stmtlist
-#line 199 "parser.yy"
+  case 33: // stmtlist: stmtlist stmt "end of line"
+#line 202 "parser.yy"
                              {
-           if ((yystack_[0].value.yxlangnode) == NULL) {
-             (yylhs.value.yxlangnode) = (yystack_[2].value.yxlangnode);
-           } else {
-             (yylhs.value.yxlangnode) = new CNStatement((yystack_[2].value.yxlangnode), (yystack_[0].value.yxlangnode));
-           }
+           (yylhs.value.yxlangnode) = driver.statement((yystack_[2].value.yxlangnode), (yystack_[1].value.yxlangnode));
          }
-#line 962 "parser.cc"
+#line 890 "parser.cc"
     break;
 
-  case 34: // stmtlist: stmt "end of file" stmtlist
-#line 206 "parser.yy"
+  case 34: // stmtlist: stmtlist stmt "end of file"
+#line 205 "parser.yy"
                              {
-           if ((yystack_[0].value.yxlangnode) == NULL) {
-             (yylhs.value.yxlangnode) = (yystack_[2].value.yxlangnode);
-           } else {
-             (yylhs.value.yxlangnode) = new CNStatement((yystack_[2].value.yxlangnode), (yystack_[0].value.yxlangnode));
-           }
+           (yylhs.value.yxlangnode) = driver.statement((yystack_[2].value.yxlangnode), (yystack_[1].value.yxlangnode));
          }
-#line 974 "parser.cc"
+#line 898 "parser.cc"
     break;
 
   case 35: // start: stmtlist
-#line 215 "parser.yy"
-               { driver.calc.expressions.push_back((yystack_[0].value.yxlangnode)); }
-#line 980 "parser.cc"
+#line 210 "parser.yy"
+               {
+        if (!driver.streaming)
+          driver.calc.expressions.push_back((yystack_[0].value.yxlangnode));
+      }
+#line 907 "parser.cc"
     break;
 
 
-#line 984 "parser.cc"
+#line 911 "parser.cc"
 
             default:
               break;
@@ -1332,95 +1259,101 @@ namespace yxlang {
   }
 
 
-  const signed char Parser::yypact_ninf_ = -58;
+  const signed char Parser::yypact_ninf_ = -57;
 
   const signed char Parser::yytable_ninf_ = -1;
 
   const signed char
   Parser::yypact_[] =
   {
-      29,    35,    -6,   -58,   -58,    -9,     4,    12,    35,   -58,
-     -58,   -58,    90,   -58,   -58,   -58,    11,   -58,    20,    16,
-      -2,    46,    35,    35,    35,    35,    63,    35,    35,    35,
-      35,    35,    35,    29,    29,   -58,    29,    30,    90,    45,
-      25,    72,    54,   -58,    99,    33,    33,   -58,   -58,   -58,
-     -58,   -58,    52,     3,    31,    47,    35,   -58,   -58,    35,
-      29,    29,   -58,    30,    71,   -58,    81,   -58,    89,   -58,
-      29,   -58,   -58,   -58
+     -57,    45,     5,    65,     4,   -57,   -57,    30,    -2,    12,
+      65,   -57,   -57,   -57,   116,   -57,   -57,   -57,    32,   -57,
+      15,    53,    22,    65,    65,    65,    65,    89,    65,    65,
+      65,    65,    65,    65,   -57,   -57,   -57,     7,   116,    71,
+      24,    98,    80,   -57,   125,   -16,   -16,   -57,   -57,   -57,
+       3,    21,    25,    65,   -57,   -57,    65,   -57,   -57,    36,
+       7,    46,   -57,   107,    28,   -57,   -57,   -57,   -57,   -57,
+      45
   };
 
   const signed char
   Parser::yydefact_[] =
   {
-      32,     0,     0,     2,     3,     4,     0,     0,     0,     5,
-       6,    17,    26,    28,    27,    29,     0,    35,     0,     4,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,    32,    32,     1,    30,     0,    20,    18,
+      32,    35,     0,     0,     0,     2,     3,     4,     0,     0,
+       0,     5,     6,    17,    26,    28,    27,    29,     0,     1,
+       4,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,    34,    33,    30,     0,    20,    18,
        0,     0,     0,     7,    13,     8,     9,    10,    11,    12,
-      34,    33,     0,     0,    24,     0,     0,    16,    14,     0,
-      30,    30,    21,     0,     0,    19,     0,    31,     0,    25,
-      30,    15,    22,    23
+       0,    24,     0,     0,    16,    14,     0,    30,    21,     0,
+       0,     0,    19,     0,     0,    31,    25,    30,    15,    22,
+      23
   };
 
   const signed char
   Parser::yypgoto_[] =
   {
-     -58,   -58,   -58,   -58,    -1,    22,   -58,   -58,   -58,    24,
-       1,   -57,    26,   -58
+     -57,   -57,   -57,   -57,    -3,     9,   -57,   -57,   -57,     8,
+      62,   -56,   -57,   -57
   };
 
   const signed char
   Parser::yydefgoto_[] =
   {
-       0,     9,    10,    11,    12,    40,    13,    14,    15,    55,
-      52,    53,    17,    18
+       0,    11,    12,    13,    14,    40,    15,    16,    17,    52,
+      59,    50,     1,     2
   };
 
   const signed char
   Parser::yytable_[] =
   {
-      20,    16,    36,    67,    68,    21,    22,    26,    61,    62,
-      27,    33,    23,    73,    28,    29,    30,    31,    32,    34,
-      35,    38,    39,    41,    42,    24,    44,    45,    46,    47,
-      48,    49,     1,    25,    16,    16,     2,    23,     3,     4,
-       5,    54,     6,     7,     3,     4,    19,    57,     6,     7,
-       8,    30,    31,    32,    63,    39,     8,    27,    66,    50,
-      51,    28,    29,    30,    31,    32,    27,    37,    56,    64,
-      28,    29,    30,    31,    32,    27,    60,    59,    65,    28,
-      29,    30,    31,    32,    27,    43,    70,    69,    28,    29,
-      30,    31,    32,    27,    58,    72,     0,    28,    29,    30,
-      31,    32,    27,    71,     0,     0,    28,    29,    30,    31,
-      32,    -1,     0,     0,     0,    28,    29,    30,    31,    32
+      21,    64,    31,    32,    33,    19,     3,    27,    57,    58,
+       4,    70,     5,     6,     7,    22,     8,     9,    51,    25,
+      38,    39,    41,    42,    10,    44,    45,    46,    47,    48,
+      49,     3,    34,    26,    69,     4,    24,     5,     6,     7,
+      35,     8,     9,    37,    60,    23,    54,    61,     3,    10,
+      39,    24,     4,    63,     5,     6,     7,    36,     8,     9,
+      65,    67,    62,    18,     0,    28,    10,     0,    66,    29,
+      30,    31,    32,    33,     5,     6,    20,     0,     8,     9,
+       0,     0,     0,    28,     0,     0,    10,    29,    30,    31,
+      32,    33,    28,     0,    53,     0,    29,    30,    31,    32,
+      33,    28,     0,    56,     0,    29,    30,    31,    32,    33,
+      28,    43,     0,     0,    29,    30,    31,    32,    33,    28,
+      55,     0,     0,    29,    30,    31,    32,    33,    28,    68,
+       0,     0,    29,    30,    31,    32,    33,    -1,     0,     0,
+       0,    29,    30,    31,    32,    33
   };
 
   const signed char
   Parser::yycheck_[] =
   {
-       1,     0,     4,    60,    61,    11,    15,     8,     5,     6,
-      12,     0,    21,    70,    16,    17,    18,    19,    20,     8,
-       0,    22,    23,    24,    25,    21,    27,    28,    29,    30,
-      31,    32,     3,    21,    33,    34,     7,    21,     9,    10,
-      11,    11,    13,    14,     9,    10,    11,    22,    13,    14,
-      21,    18,    19,    20,    23,    56,    21,    12,    59,    33,
-      34,    16,    17,    18,    19,    20,    12,    21,    23,    22,
-      16,    17,    18,    19,    20,    12,    24,    23,    56,    16,
-      17,    18,    19,    20,    12,    22,    15,    63,    16,    17,
-      18,    19,    20,    12,    22,     6,    -1,    16,    17,    18,
-      19,    20,    12,    22,    -1,    -1,    16,    17,    18,    19,
-      20,    12,    -1,    -1,    -1,    16,    17,    18,    19,    20
+       3,    57,    18,    19,    20,     0,     3,    10,     5,     6,
+       7,    67,     9,    10,    11,    11,    13,    14,    11,    21,
+      23,    24,    25,    26,    21,    28,    29,    30,    31,    32,
+      33,     3,     0,    21,     6,     7,    21,     9,    10,    11,
+       8,    13,    14,    21,    23,    15,    22,    22,     3,    21,
+      53,    21,     7,    56,     9,    10,    11,     4,    13,    14,
+      24,    15,    53,     1,    -1,    12,    21,    -1,    60,    16,
+      17,    18,    19,    20,     9,    10,    11,    -1,    13,    14,
+      -1,    -1,    -1,    12,    -1,    -1,    21,    16,    17,    18,
+      19,    20,    12,    -1,    23,    -1,    16,    17,    18,    19,
+      20,    12,    -1,    23,    -1,    16,    17,    18,    19,    20,
+      12,    22,    -1,    -1,    16,    17,    18,    19,    20,    12,
+      22,    -1,    -1,    16,    17,    18,    19,    20,    12,    22,
+      -1,    -1,    16,    17,    18,    19,    20,    12,    -1,    -1,
+      -1,    16,    17,    18,    19,    20
   };
 
   const signed char
   Parser::yystos_[] =
   {
-       0,     3,     7,     9,    10,    11,    13,    14,    21,    26,
-      27,    28,    29,    31,    32,    33,    35,    37,    38,    11,
-      29,    11,    15,    21,    21,    21,    29,    12,    16,    17,
-      18,    19,    20,     0,     8,     0,     4,    21,    29,    29,
+       0,    37,    38,     3,     7,     9,    10,    11,    13,    14,
+      21,    26,    27,    28,    29,    31,    32,    33,    35,     0,
+      11,    29,    11,    15,    21,    21,    21,    29,    12,    16,
+      17,    18,    19,    20,     0,     8,     4,    21,    29,    29,
       30,    29,    29,    22,    29,    29,    29,    29,    29,    29,
-      37,    37,    35,    36,    11,    34,    23,    22,    22,    23,
-      24,     5,     6,    23,    22,    30,    29,    36,    36,    34,
-      15,    22,     6,    36
+      36,    11,    34,    23,    22,    22,    23,     5,     6,    35,
+      23,    22,    30,    29,    36,    24,    34,    15,    22,     6,
+      36
   };
 
   const signed char
@@ -1462,10 +1395,10 @@ namespace yxlang {
   const unsigned char
   Parser::yyrline_[] =
   {
-       0,   105,   105,   108,   112,   116,   119,   122,   126,   129,
-     132,   135,   138,   141,   144,   147,   150,   153,   155,   158,
-     162,   166,   169,   173,   177,   180,   184,   185,   186,   187,
-     189,   190,   198,   199,   206,   215
+       0,   103,   103,   106,   110,   114,   117,   120,   124,   127,
+     130,   133,   136,   139,   142,   145,   148,   151,   153,   156,
+     160,   164,   167,   171,   181,   184,   188,   189,   190,   191,
+     193,   194,   201,   202,   205,   210
   };
 
   void
@@ -1496,7 +1429,7 @@ namespace yxlang {
 #endif // YXLANGDEBUG
 
   Parser::symbol_kind_type
-  Parser::yytranslate_ (int t)
+  Parser::yytranslate_ (int t) YY_NOEXCEPT
   {
     // YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to
     // TOKEN-NUM as returned by yylex.
@@ -1544,9 +1477,9 @@ namespace yxlang {
   }
 
 } // yxlang
-#line 1548 "parser.cc"
+#line 1481 "parser.cc"
 
-#line 219 "parser.yy"
+#line 217 "parser.yy"
  /*** Additional Code ***/
 
 void yxlang::Parser::error(const Parser::location_type& l, const std::string& m) {
@@ -58,7 +58,7 @@
 %union {
     int  			    integerVal;
     double 			    doubleVal;
-    std::string*		stringVal;
+    unsigned int		symbolVal;
     class YxlangNode*	yxlangnode;
     int                 fn;
 }
@@ -69,14 +69,12 @@
 %token			     EOL		"end of line"
 %token <integerVal>  INTEGER	"integer"
 %token <doubleVal> 	 DOUBLE		"double"
-%token <stringVal> 	 STRING		"string"
+%token <symbolVal> 	 STRING		"string"
 
 %type <yxlangnode>	    constant variable
 %type <yxlangnode>	    atomexpr expr exprlist assignment ifstmt paramlist funcstmt stmt sentencelist stmtlist
 
-%destructor { delete $$; } STRING
-%destructor { delete $$; } constant variable
-%destructor { delete $$; } atomexpr expr exprlist assignment ifstmt funcstmt stmt sentencelist stmtlist
+/* nodes live in the context's arena, discarded ones go with it */
 
 %nonassoc <fn> CMP UNARYFUNC BINARYFUNC
 %right '='
@@ -103,14 +101,14 @@
  /*** BEGIN YXLANG - Change the yxlang grammar rules below ***/
 
 constant : INTEGER {
-	       $$ = new CNConstant($1);
+	       $$ = new (driver.calc.getArena()) CNConstant($1);
 	     }
          | DOUBLE {
-	       $$ = new CNConstant($1);
+	       $$ = new (driver.calc.getArena()) CNConstant($1);
 	     }
 
 variable : STRING {
-           $$ = new CNVariable($1);
+           $$ = new (driver.calc.getArena()) CNVariable($1);
 	     }
 
 atomexpr : constant {
@@ -124,61 +122,67 @@ atomexpr : constant {
 	     }
 
 expr : expr '+' expr {
-	   $$ = new CNAdd($1, $3);
+	   $$ = new (driver.calc.getArena()) CNAdd($1, $3);
      }
      | expr '-' expr {
-	   $$ = new CNSubtract($1, $3);
+	   $$ = new (driver.calc.getArena()) CNSubtract($1, $3);
      }
      | expr '*' expr {
-	   $$ = new CNMultiply($1, $3);
+	   $$ = new (driver.calc.getArena()) CNMultiply($1, $3);
      }
      | expr '/' expr {
-	   $$ = new CNDivide($1, $3);
+	   $$ = new (driver.calc.getArena()) CNDivide($1, $3);
      }
      | expr '%' expr {
-	   $$ = new CNModulo($1, $3);
+	   $$ = new (driver.calc.getArena()) CNModulo($1, $3);
      }
      | expr CMP expr {
-	   $$ = new CNCompare($2, $1, $3);
+	   $$ = new (driver.calc.getArena()) CNCompare($2, $1, $3);
      }
      | UNARYFUNC '(' expr ')' {
-	   $$ = new CNUnaryFunction($1, $3);
+	   $$ = new (driver.calc.getArena()) CNUnaryFunction($1, $3);
      }
      | BINARYFUNC '(' expr ',' expr ')' {
-	   $$ = new CNBinaryFunction($1, $3, $5);
+	   $$ = new (driver.calc.getArena()) CNBinaryFunction($1, $3, $5);
      }
      | STRING '(' exprlist ')' {
-	   $$ = new CNCallUDF($1, $3);
+	   $$ = new (driver.calc.getArena()) CNCallUDF($1, $3);
      }
      | atomexpr
 
 exprlist : expr {
-           $$ = new CNExprlist($1, NULL);
+           $$ = new (driver.calc.getArena()) CNExprlist($1, NULL);
          }
          | expr ',' exprlist {
-           $$ = new CNExprlist($1, $3);
+           $$ = new (driver.calc.getArena()) CNExprlist($1, $3);
          }
 
 assignment : STRING '=' expr {
-           $$ = new CNAssignment($1, $3);
+           $$ = new (driver.calc.getArena()) CNAssignment($1, $3);
 	     }
 
 ifstmt : IF expr THEN sentencelist FI  {
-         $$ = new CNCondition($2, $4, NULL);
+         $$ = new (driver.calc.getArena()) CNCondition($2, $4, NULL);
        }
        | IF expr THEN sentencelist ELSE sentencelist FI {
-         $$ = new CNCondition($2, $4, $6);
+         $$ = new (driver.calc.getArena()) CNCondition($2, $4, $6);
        }
 
 funcstmt : LET STRING '(' paramlist ')' '=' sentencelist {
-           $$ = new CNCustomFunction($2, $4, $7);
+           CNCustomFunction* function = new (driver.calc.getArena()) CNCustomFunction($2, $4, $7);
+           function->resolve(driver.calc.getArena());
+           function->serial = ++driver.calc.serials;
+           function->arena = &driver.calc.getArena();
+           $$ = function;
+           /* the definition outlives the expressions of this parse */
+           driver.calc.getArena().pin();
          }
 
 paramlist : STRING {
-            $$ = new CNParamlist($1, NULL);
+            $$ = new (driver.calc.getArena()) CNParamlist($1, NULL);
           }
           | STRING ',' paramlist {
-            $$ = new CNParamlist($1, $3);
+            $$ = new (driver.calc.getArena()) CNParamlist($1, $3);
           }
 
 stmt   : expr
@@ -187,32 +191,26 @@ stmt   : expr
        | funcstmt
 
 sentencelist : { $$ = NULL; }
-         | stmt ';' sentencelist {
-           if ($3 == NULL) {
-             $$ = $1;
-           } else {
-             $$ = new CNStatement($1, $3);
-           }
+         | sentencelist stmt ';' {
+           $$ = CNBlock::join(driver.calc.getArena(), $1, $2);
          }
 
+/* left recursive, so the parser stack stays flat however long the input
+ * is. The driver appends each statement to the block, or runs it right
+ * away when streaming. */
 stmtlist : { $$ = NULL; }
-         | stmt EOL stmtlist {
-           if ($3 == NULL) {
-             $$ = $1;
-           } else {
-             $$ = new CNStatement($1, $3);
-           }
+         | stmtlist stmt EOL {
+           $$ = driver.statement($1, $2);
          }
-         | stmt END stmtlist {
-           if ($3 == NULL) {
-             $$ = $1;
-           } else {
-             $$ = new CNStatement($1, $3);
-           }
+         | stmtlist stmt END {
+           $$ = driver.statement($1, $2);
          }
 
 start : 
-      stmtlist { driver.calc.expressions.push_back($1); }      
+      stmtlist {
+        if (!driver.streaming)
+          driver.calc.expressions.push_back($1);
+      }
 
  /*** END YXLANG - Change the yxlang grammar rules above ***/
 
@@ -0,0 +1,164 @@
+/**
+ * @file reactive.cc
+ * @brief recompute only the statements a variable change reaches
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <string.h>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <functional>
+#include "reactive.h"
+
+namespace {
+
+/** variables node reads and assigns when evaluated, with those of the
+ * bodies of the functions it calls as they are defined now */
+void collect(const YxlangContext &calc, const YxlangNode* node, std::set<unsigned int> &reads, std::set<unsigned int> &writes, std::set<const CNCustomFunction*> &seen) {
+    if (!node)
+        return;
+
+    switch (node->type()) {
+        case NT_VARIABLE:
+            reads.insert(static_cast<const CNVariable*>(node)->slot);
+            break;
+        case NT_ASSIGNMENT:
+            writes.insert(static_cast<const CNAssignment*>(node)->slot);
+            break;
+        case NT_SHAREREF:
+            /* the share is evaluated by an earlier statement, which reads
+             * the same variables */
+            collect(calc, static_cast<const CNShareRef*>(node)->share->node, reads, writes, seen);
+            return;
+        case NT_CALLUDF: {
+            const CNCustomFunction* callee = calc.getFunction(static_cast<const CNCallUDF*>(node)->symbol);
+            if (callee && seen.insert(callee).second)
+                collect(calc, callee->right, reads, writes, seen);
+            break;
+        }
+        case NT_CUSTOMFUNCTION:
+            /* the body runs when called, not here */
+            return;
+        default:
+            break;
+    }
+
+    YxlangNode::Children children(node);
+    unsigned int n = children.size();
+    for (unsigned int i = 0; i < n; ++i)
+        collect(calc, children[i], reads, writes, seen);
+}
+
+bool same(double a, double b) {
+    return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+} // namespace
+
+void YxlangReactive::build(YxlangContext &calc) {
+    invalidate();
+    for (size_t i = 0; i < calc.expressions.size(); ++i) {
+        const YxlangNode* node = calc.expressions[i];
+        if (node && node->type() == NT_BLOCK) {
+            const CNBlock* block = static_cast<const CNBlock*>(node);
+            for (unsigned int s = 0; s < block->count; ++s)
+                add(calc, block->statements[s]);
+        } else {
+            add(calc, node);
+        }
+    }
+    built = calc.expressions;
+    definitions = calc.definitions;
+    queued.assign(cells.size(), 0);
+
+    std::map<unsigned int, size_t> writer;
+    linear = true;
+    for (size_t i = 0; i < cells.size() && linear; ++i) {
+        for (size_t w = 0; w < cells[i].writes.size() && linear; ++w)
+            linear = writer.insert(std::make_pair(cells[i].writes[w], i)).second;
+    }
+    for (std::map<unsigned int, size_t>::const_iterator wi = writer.begin(); wi != writer.end() && linear; ++wi) {
+        /* readers are in program order, the first one has to come later */
+        linear = wi->first >= readers.size() || readers[wi->first].empty() || readers[wi->first].front() > wi->second;
+    }
+}
+
+void YxlangReactive::add(YxlangContext &calc, const YxlangNode* node) {
+    /* a definition has nothing to recompute */
+    if (!node || node->type() == NT_CUSTOMFUNCTION)
+        return;
+
+    std::set<unsigned int> reads;
+    std::set<unsigned int> writes;
+    std::set<const CNCustomFunction*> seen;
+    collect(calc, node, reads, writes, seen);
+
+    Cell cell;
+    cell.node = node;
+    cell.writes.assign(writes.begin(), writes.end());
+    for (std::set<unsigned int>::const_iterator ri = reads.begin(); ri != reads.end(); ++ri) {
+        if (*ri >= readers.size())
+            readers.resize(*ri + 1);
+        readers[*ri].push_back(cells.size());
+    }
+    cells.push_back(cell);
+}
+
+void YxlangReactive::touch(unsigned int slot, size_t first) {
+    if (slot >= readers.size())
+        return;
+    const std::vector<size_t> &cellsreading = readers[slot];
+    for (std::vector<size_t>::const_iterator ci = std::lower_bound(cellsreading.begin(), cellsreading.end(), first); ci != cellsreading.end(); ++ci) {
+        if (!queued[*ci]) {
+            queued[*ci] = 1;
+            pending.push_back(*ci);
+            std::push_heap(pending.begin(), pending.end(), std::greater<size_t>());
+        }
+    }
+}
+
+size_t YxlangReactive::update(YxlangContext &calc, unsigned int slot, double value) {
+    if (built != calc.expressions || definitions != calc.definitions)
+        build(calc);
+
+    double old = calc.variables[slot];
+    calc.variables[slot] = value;
+    if (same(old, value))
+        return 0;
+
+    size_t count = 0;
+    if (!linear) {
+        for (size_t i = 0; i < cells.size(); ++i) {
+            if (std::find(cells[i].writes.begin(), cells[i].writes.end(), slot) == cells[i].writes.end()) {
+                cells[i].node->evaluate(calc);
+                ++count;
+            }
+        }
+        evaluated += count;
+        return count;
+    }
+
+    std::vector<double> before;
+    touch(slot, 0);
+    while (!pending.empty()) {
+        std::pop_heap(pending.begin(), pending.end(), std::greater<size_t>());
+        size_t i = pending.back();
+        pending.pop_back();
+        queued[i] = 0;
+
+        const Cell &cell = cells[i];
+        before.resize(cell.writes.size());
+        for (size_t w = 0; w < cell.writes.size(); ++w)
+            before[w] = calc.variables[cell.writes[w]];
+        cell.node->evaluate(calc);
+        ++count;
+        for (size_t w = 0; w < cell.writes.size(); ++w) {
+            if (!same(before[w], calc.variables[cell.writes[w]]))
+                touch(cell.writes[w], i + 1);
+        }
+    }
+    evaluated += count;
+    return count;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file reactive.h
+ * @brief recompute only the statements a variable change reaches
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#ifndef REACTIVE_H
+#define REACTIVE_H
+
+#include <vector>
+#include "expression.h"
+
+/** Dependency graph of the top level statements of a context's
+ * expressions, for using them like the cells of a spreadsheet. Each
+ * statement records the variables it reads and assigns, also through the
+ * functions it calls. Changing a variable re-evaluates the statements
+ * reading it, then those reading what they assigned, and so on, each
+ * statement after the ones it depends on, in program order. A statement
+ * whose assignments leave every value as it was does not reach further.
+ * A statement assigning the changed variable itself is not run again, so
+ * the new value stays.
+ *
+ * This gives what running all statements again would, as long as every
+ * variable is assigned by at most one statement and only read after it,
+ * like the cells of a spreadsheet. Otherwise a statement may read a value
+ * meant for a later one, so if any variable is assigned twice or read
+ * before or by its assignment, as in n = n + 1, every statement but those
+ * assigning the changed variable is run again.
+ *
+ * Statements are re-evaluated by the tree walker. The graph is built on
+ * the first change and rebuilt once the expressions or the function
+ * definitions have changed. */
+class YxlangReactive {
+public:
+    /// statements re-evaluated so far
+    unsigned long	evaluated;
+
+    YxlangReactive() : evaluated(0), definitions(0), linear(true) {
+    }
+
+    /** set the variable in slot to value and re-evaluate what depends on
+     * it, returns the number of statements evaluated */
+    size_t	update(YxlangContext &calc, unsigned int slot, double value);
+
+    /** forget the graph, the expressions it was built from are gone */
+    void	invalidate() {
+        cells.clear();
+        readers.clear();
+        built.clear();
+    }
+
+    /** number of statements in the graph */
+    size_t size() const {
+        return cells.size();
+    }
+    /** false if a change runs all statements again */
+    bool isLinear() const {
+        return linear;
+    }
+
+private:
+    struct Cell {
+        const YxlangNode*	node;
+        /// slots the statement assigns
+        std::vector<unsigned int>	writes;
+    };
+
+    void	build(YxlangContext &calc);
+    void	add(YxlangContext &calc, const YxlangNode* node);
+    /** queue the statements from first on that read slot */
+    void	touch(unsigned int slot, size_t first);
+
+    std::vector<Cell>	cells;
+    /// statements reading each slot, in program order, indexed by slot
+    std::vector<std::vector<size_t> >	readers;
+    /// the expressions and definitions the graph was built from
+    std::vector<YxlangNode*>	built;
+    unsigned long	definitions;
+    /// every variable is assigned once at most, and only read after that
+    bool	linear;
+    /// statements waiting to be evaluated, as a min-heap
+    std::vector<size_t>	pending;
+    std::vector<char>	queued;
+};
+
+#endif // REACTIVE_H
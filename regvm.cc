@@ -0,0 +1,332 @@
+/**
+ * @file regvm.cc
+ * @brief register VM with direct-threaded dispatch
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <cmath>
+#include <iostream>
+#include "regvm.h"
+
+RegisterProgram* RegisterCompiler::compile(YxlangContext &calc, const YxlangNode* node) {
+    RegisterProgram* program = new RegisterProgram();
+    RegisterCompiler compiler(calc, program);
+    /* every node needs at most one temporary, so the register file never
+     * grows and the operand pointers stay valid */
+    program->registers.resize(compiler.prepare(node) + 1);
+    const double* v = compiler.compileNode(node, NULL);
+    compiler.emit(ROP_HALT, NULL, v);
+    return program;
+}
+
+unsigned int RegisterCompiler::prepare(const YxlangNode* node) {
+    if (!node)
+        return 0;
+
+    unsigned int n = 1;
+    bool call = node->type() == NT_CALLUDF;
+    YxlangNode::Children children(node);
+    unsigned int count = children.size();
+    for (unsigned int i = 0; i < count; ++i) {
+        if (children[i]) {
+            n += prepare(children[i]);
+            call = call || calls.count(children[i]);
+        }
+    }
+    if (call)
+        calls.insert(node);
+    return n;
+}
+
+int RegisterCompiler::emit(RegisterOpcode op, double* d, const double* a, const double* b, int target, unsigned short count) {
+    RegisterInstr instr;
+    instr.handler = NULL;
+    instr.op = op;
+    instr.count = count;
+    instr.target = target;
+    instr.d = d;
+    instr.a = a;
+    instr.b = b;
+    program->code.push_back(instr);
+    return program->code.size() - 1;
+}
+
+const double* RegisterCompiler::constant(double value) {
+    program->constants.push_back(value);
+    return &program->constants.back();
+}
+
+double* RegisterCompiler::variable(unsigned int slot) {
+    return &calc.variables[slot];
+}
+
+const double* RegisterCompiler::move(const double* src, double* dst) {
+    if (!dst || dst == src)
+        return src;
+    emit(ROP_MOVE, dst, src);
+    return dst;
+}
+
+const double* RegisterCompiler::compileUnary(RegisterOpcode op, const YxlangNode* left, double* dst) {
+    unsigned int mark = ntemps;
+    const double* a = compileNode(left, NULL);
+    ntemps = mark;
+    double* d = result(dst);
+    emit(op, d, a);
+    return d;
+}
+
+const double* RegisterCompiler::compileBinary(RegisterOpcode op, const YxlangNode* left, const YxlangNode* right, double* dst) {
+    unsigned int mark = ntemps;
+    const double* a = compileNode(left, NULL);
+    /* the tree walker reads a variable before evaluating its right
+     * sibling, a UDF called there may assign it */
+    if (left && (left->type() == NT_VARIABLE || left->type() == NT_SHAREREF) && calls.count(right))
+        a = move(a, alloc());
+    const double* b = compileNode(right, NULL);
+    ntemps = mark;
+    double* d = result(dst);
+    emit(op, d, a, b);
+    return d;
+}
+
+const double* RegisterCompiler::compileNode(const YxlangNode* node, double* dst) {
+    if (!node)
+        return move(constant(0), dst);
+
+    switch (node->type()) {
+        case NT_CONSTANT:
+            return move(constant(static_cast<const CNConstant*>(node)->value), dst);
+        case NT_VARIABLE:
+            return move(variable(static_cast<const CNVariable*>(node)->slot), dst);
+        case NT_NEGATE:
+            return compileUnary(ROP_NEG, static_cast<const CNNegate*>(node)->node, dst);
+        case NT_ADD: {
+            const CNAdd* n = static_cast<const CNAdd*>(node);
+            return compileBinary(ROP_ADD, n->left, n->right, dst);
+        }
+        case NT_SUBTRACT: {
+            const CNSubtract* n = static_cast<const CNSubtract*>(node);
+            return compileBinary(ROP_SUB, n->left, n->right, dst);
+        }
+        case NT_MULTIPLY: {
+            const CNMultiply* n = static_cast<const CNMultiply*>(node);
+            return compileBinary(ROP_MUL, n->left, n->right, dst);
+        }
+        case NT_DIVIDE: {
+            const CNDivide* n = static_cast<const CNDivide*>(node);
+            return compileBinary(ROP_DIV, n->left, n->right, dst);
+        }
+        case NT_MODULO: {
+            const CNModulo* n = static_cast<const CNModulo*>(node);
+            return compileBinary(ROP_MOD, n->left, n->right, dst);
+        }
+        case NT_POWER: {
+            const CNPower* n = static_cast<const CNPower*>(node);
+            return compileBinary(ROP_POW, n->left, n->right, dst);
+        }
+        case NT_COMPARE: {
+            const CNCompare* n = static_cast<const CNCompare*>(node);
+            RegisterOpcode op = ROP_GT;
+            switch (n->fn) {
+                case CMP_GT: op = ROP_GT; break;
+                case CMP_LT: op = ROP_LT; break;
+                case CMP_NE: op = ROP_NE; break;
+                case CMP_EQ: op = ROP_EQ; break;
+                case CMP_GE: op = ROP_GE; break;
+                case CMP_LE: op = ROP_LE; break;
+            }
+            return compileBinary(op, n->left, n->right, dst);
+        }
+        case NT_UNARYFUNCTION: {
+            const CNUnaryFunction* n = static_cast<const CNUnaryFunction*>(node);
+            RegisterOpcode op = ROP_SQRT;
+            switch (n->fn) {
+                case UF_SQRT: op = ROP_SQRT; break;
+                case UF_EXP: op = ROP_EXP; break;
+                case UF_LOG: op = ROP_LOG; break;
+                case UF_PRINT: op = ROP_PRINT; break;
+            }
+            return compileUnary(op, n->left, dst);
+        }
+        case NT_BINARYFUNCTION: {
+            const CNBinaryFunction* n = static_cast<const CNBinaryFunction*>(node);
+            return compileBinary(ROP_POW, n->left, n->right, dst);
+        }
+        case NT_EXPRLIST:
+            return compileNode(static_cast<const CNExprlist*>(node)->left, dst);
+        case NT_ASSIGNMENT: {
+            const CNAssignment* n = static_cast<const CNAssignment*>(node);
+            double* var = variable(n->slot);
+            compileNode(n->left, var);
+            return move(var, dst);
+        }
+        case NT_CONDITION: {
+            const CNCondition* n = static_cast<const CNCondition*>(node);
+            unsigned int mark = ntemps;
+            double* d = result(dst);
+            const double* c = compileNode(n->cond, NULL);
+            int jumpf = emit(ROP_JUMPF, NULL, c);
+            compileNode(n->left, d);
+            int jump = emit(ROP_JUMP, NULL);
+            program->code[jumpf].target = program->code.size();
+            compileNode(n->right, d);
+            program->code[jump].target = program->code.size();
+            ntemps = dst ? mark : mark + 1;
+            return d;
+        }
+        case NT_BLOCK: {
+            const CNBlock* n = static_cast<const CNBlock*>(node);
+            unsigned int mark = ntemps;
+            for (unsigned int i = 0; i + 1 < n->count; ++i) {
+                compileNode(n->statements[i], NULL);
+                ntemps = mark;
+            }
+            return compileNode(n->count ? n->statements[n->count - 1] : NULL, dst);
+        }
+        /* parameters only occur in function bodies, the tree walker runs them */
+        case NT_PARAMETER:
+        case NT_PARAMASSIGN:
+        case NT_PARAMLIST:
+            return move(constant(0), dst);
+        case NT_CUSTOMFUNCTION: {
+            program->functions.push_back(static_cast<const CNCustomFunction*>(node));
+            double* d = result(dst);
+            emit(ROP_DEFINE, d, NULL, NULL, program->functions.size() - 1);
+            return d;
+        }
+        case NT_GUARD: {
+            program->guards.push_back(static_cast<const CNGuard*>(node));
+            double* d = result(dst);
+            emit(ROP_GUARD, d, NULL, NULL, program->guards.size() - 1);
+            return d;
+        }
+        case NT_SHARE: {
+            const CNShare* n = static_cast<const CNShare*>(node);
+            compileNode(n->node, &n->value);
+            return move(&n->value, dst);
+        }
+        case NT_SHAREREF:
+            return move(&static_cast<const CNShareRef*>(node)->share->value, dst);
+        case NT_CALLUDF: {
+            const CNCallUDF* n = static_cast<const CNCallUDF*>(node);
+            unsigned int mark = ntemps;
+            unsigned short nargs = n->nargs();
+            /* arguments go to consecutive registers, reserved up front */
+            double* args = &program->registers[ntemps];
+            ntemps += nargs;
+            unsigned int i = 0;
+            for (CNCallUDF::Arguments a(n); !a.done(); a.next(), ++i)
+                compileNode(a.node(), args + i);
+            ntemps = mark;
+            double* d = result(dst);
+            emit(ROP_CALL, d, args, NULL, n->symbol, nargs);
+            return d;
+        }
+    }
+    return move(constant(0), dst);
+}
+
+double RegisterProgram::run(YxlangContext &calc) {
+    static const void* const labels[ROP_COUNT] = {
+        &&op_move, &&op_neg, &&op_sqrt, &&op_exp, &&op_log, &&op_print,
+        &&op_add, &&op_sub, &&op_mul, &&op_div, &&op_mod, &&op_pow,
+        &&op_gt, &&op_lt, &&op_ne, &&op_eq, &&op_ge, &&op_le,
+        &&op_jump, &&op_jumpf, &&op_call, &&op_define, &&op_guard, &&op_halt
+    };
+    if (!threaded) {
+        for (unsigned int i = 0; i < code.size(); ++i)
+            code[i].handler = labels[code[i].op];
+        threaded = true;
+    }
+
+    const RegisterInstr* base = &code[0];
+    const RegisterInstr* pc = base;
+
+#define DISPATCH()  goto *pc->handler
+#define NEXT()      do { ++pc; DISPATCH(); } while (0)
+
+    DISPATCH();
+
+op_move:
+    *pc->d = *pc->a;
+    NEXT();
+op_neg:
+    *pc->d = - *pc->a;
+    NEXT();
+op_sqrt:
+    *pc->d = std::sqrt(*pc->a);
+    NEXT();
+op_exp:
+    *pc->d = std::exp(*pc->a);
+    NEXT();
+op_log:
+    *pc->d = std::log(*pc->a);
+    NEXT();
+op_print:
+    std::cout << "= " << *pc->a << std::endl;
+    *pc->d = *pc->a;
+    NEXT();
+op_add:
+    *pc->d = *pc->a + *pc->b;
+    NEXT();
+op_sub:
+    *pc->d = *pc->a - *pc->b;
+    NEXT();
+op_mul:
+    *pc->d = *pc->a * *pc->b;
+    NEXT();
+op_div:
+    *pc->d = *pc->a / *pc->b;
+    NEXT();
+op_mod:
+    *pc->d = std::fmod(*pc->a, *pc->b);
+    NEXT();
+op_pow:
+    *pc->d = std::pow(*pc->a, *pc->b);
+    NEXT();
+op_gt:
+    *pc->d = *pc->a > *pc->b ? 1 : 0;
+    NEXT();
+op_lt:
+    *pc->d = *pc->a < *pc->b ? 1 : 0;
+    NEXT();
+op_ne:
+    *pc->d = *pc->a != *pc->b ? 1 : 0;
+    NEXT();
+op_eq:
+    *pc->d = *pc->a == *pc->b ? 1 : 0;
+    NEXT();
+op_ge:
+    *pc->d = *pc->a >= *pc->b ? 1 : 0;
+    NEXT();
+op_le:
+    *pc->d = *pc->a <= *pc->b ? 1 : 0;
+    NEXT();
+op_jump:
+    pc = base + pc->target;
+    DISPATCH();
+op_jumpf:
+    if (!YxlangNode::truth(*pc->a)) {
+        pc = base + pc->target;
+        DISPATCH();
+    }
+    NEXT();
+op_call: {
+        YxlangContext::functionmap_type::const_iterator fi = calc.functions.find(pc->target);
+        *pc->d = fi == calc.functions.end() ? 0 : fi->second->invoke(calc, pc->a, pc->count);
+    }
+    NEXT();
+op_define:
+    *pc->d = functions[pc->target]->evaluate(calc);
+    NEXT();
+op_guard:
+    *pc->d = guards[pc->target]->check(calc) ? 1 : 0;
+    NEXT();
+op_halt:
+    return *pc->a;
+
+#undef NEXT
+#undef DISPATCH
+}
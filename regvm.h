@@ -0,0 +1,118 @@
+/**
+ * @file regvm.h
+ * @brief register VM with direct-threaded dispatch
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#ifndef REGVM_H
+#define REGVM_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <set>
+#include "expression.h"
+
+/** register VM opcodes */
+enum RegisterOpcode {
+    /// *d = *a
+    ROP_MOVE,
+    /// *d = op *a
+    ROP_NEG,
+    ROP_SQRT,
+    ROP_EXP,
+    ROP_LOG,
+    ROP_PRINT,
+    /// *d = *a op *b
+    ROP_ADD,
+    ROP_SUB,
+    ROP_MUL,
+    ROP_DIV,
+    ROP_MOD,
+    ROP_POW,
+    ROP_GT,
+    ROP_LT,
+    ROP_NE,
+    ROP_EQ,
+    ROP_GE,
+    ROP_LE,
+    /// continue at target
+    ROP_JUMP,
+    /// continue at target if *a is false
+    ROP_JUMPF,
+    /// *d = UDF with symbol id target(a[0] .. a[count-1])
+    ROP_CALL,
+    /// register functions[target], *d = 0
+    ROP_DEFINE,
+    /// *d = 1 if the inlined function of guards[target] is still defined, else 0
+    ROP_GUARD,
+    /// return *a
+    ROP_HALT,
+    ROP_COUNT
+};
+
+/** one three-address instruction. Operands point straight at registers,
+ * constants or variables, so no instruction loads or stores on its own. */
+struct RegisterInstr {
+    /// address of the handler, filled in when the code is threaded
+    const void*	handler;
+    unsigned short	op;
+    unsigned short	count;
+    int	target;
+    double*	d;
+    const double*	a;
+    const double*	b;
+};
+
+/** register code of one expression and the VM running it */
+class RegisterProgram : public YxlangProgram {
+public:
+    std::vector<RegisterInstr>	code;
+    std::vector<double>	registers;
+    std::deque<double>	constants;
+    std::vector<const CNCustomFunction*>	functions;
+    std::vector<const CNGuard*>	guards;
+
+    RegisterProgram() : threaded(false) {
+    }
+
+    virtual double	run(YxlangContext &calc);
+
+private:
+    bool	threaded;
+};
+
+/** lowers a Yxlang tree into RegisterProgram code */
+class RegisterCompiler {
+public:
+    /** the program reads and writes the variables of calc */
+    static RegisterProgram* compile(YxlangContext &calc, const YxlangNode* node);
+
+private:
+    RegisterCompiler(YxlangContext &_calc, RegisterProgram* _program) : calc(_calc), program(_program), ntemps(0) {
+    }
+
+    unsigned int	prepare(const YxlangNode* node);
+    const double*	compileNode(const YxlangNode* node, double* dst);
+    const double*	compileBinary(RegisterOpcode op, const YxlangNode* left, const YxlangNode* right, double* dst);
+    const double*	compileUnary(RegisterOpcode op, const YxlangNode* left, double* dst);
+    const double*	move(const double* src, double* dst);
+    int	emit(RegisterOpcode op, double* d, const double* a = NULL, const double* b = NULL, int target = 0, unsigned short count = 0);
+    double*	alloc() {
+        return &program->registers[ntemps++];
+    }
+    double*	result(double* dst) {
+        return dst ? dst : alloc();
+    }
+    const double*	constant(double value);
+    double*	variable(unsigned int slot);
+
+    YxlangContext&	calc;
+    RegisterProgram*	program;
+    unsigned int	ntemps;
+    /// subtrees that call a UDF and so may change any variable
+    std::set<const YxlangNode*>	calls;
+};
+
+#endif // REGVM_H
@@ -514,10 +514,10 @@ static yyconst flex_int16_t yy_chk[109] =
 
 static yyconst flex_int16_t yy_rule_linenum[34] =
     {   0,
-       61,   62,   63,   64,   65,   66,   67,   68,   69,   70,
-       71,   73,   74,   75,   76,   77,   78,   80,   81,   82,
-       83,   84,   86,   87,   88,   89,   90,   92,   94,   97,
-      100,  103,  106
+       62,   63,   64,   65,   66,   67,   68,   69,   70,   71,
+       72,   74,   75,   76,   77,   78,   79,   81,   82,   83,
+       84,   85,   87,   88,   89,   90,   91,   93,   95,   98,
+      101,  104,  107
     } ;
 
 /* The intent behind this definition is that it'll catch
@@ -538,6 +538,7 @@ static yyconst flex_int16_t yy_rule_linenum[34] =
 
 #include <string>
 #include "scanner.h"
+#include "expression.h"
 
 /* import the parser's token type into a local typedef */
 typedef yxlang::Parser::token token;
@@ -558,9 +559,9 @@ typedef yxlang::Parser::token_type token_type;
 /* enables the use of start condition stacks */
 /* The following paragraph suffices to track locations accurately. Each time
  * yylex is invoked, the begin position is moved onto the end position. */
-#line 48 "scanner.ll"
+#line 49 "scanner.ll"
 #define YY_USER_ACTION  yylloc->columns(yyleng);
-#line 564 "scanner.cc"
+#line 565 "scanner.cc"
 
 #define INITIAL 0
 
@@ -717,7 +718,7 @@ YY_DECL
 	register int yy_act;
     
 /* %% [7.0] user's declarations go here */
-#line 51 "scanner.ll"
+#line 52 "scanner.ll"
 
 
  /* code to place at the beginning of yylex() */
@@ -728,7 +729,7 @@ YY_DECL
 
  /*** BEGIN EXAMPLE - Change the yxlang lexer rules below ***/
 
-#line 732 "scanner.cc"
+#line 733 "scanner.cc"
 
 	if ( !(yy_init) )
 		{
@@ -838,152 +839,152 @@ do_action:	/* This label is used only to access EOF actions. */
 			goto yy_find_action;
 
 case 1:
-#line 62 "scanner.ll"
-case 2:
 #line 63 "scanner.ll"
-case 3:
+case 2:
 #line 64 "scanner.ll"
-case 4:
+case 3:
 #line 65 "scanner.ll"
-case 5:
+case 4:
 #line 66 "scanner.ll"
-case 6:
+case 5:
 #line 67 "scanner.ll"
-case 7:
+case 6:
 #line 68 "scanner.ll"
-case 8:
+case 7:
 #line 69 "scanner.ll"
-case 9:
+case 8:
 #line 70 "scanner.ll"
-case 10:
+case 9:
 #line 71 "scanner.ll"
+case 10:
+#line 72 "scanner.ll"
 case 11:
 YY_RULE_SETUP
-#line 71 "scanner.ll"
+#line 72 "scanner.ll"
 { return static_cast<token_type>(*yytext); }
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 73 "scanner.ll"
+#line 74 "scanner.ll"
 { yylval->fn = 1; return token::CMP; }
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
-#line 74 "scanner.ll"
+#line 75 "scanner.ll"
 { yylval->fn = 2; return token::CMP; }
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
-#line 75 "scanner.ll"
+#line 76 "scanner.ll"
 { yylval->fn = 3; return token::CMP; }
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 76 "scanner.ll"
+#line 77 "scanner.ll"
 { yylval->fn = 4; return token::CMP; }
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
-#line 77 "scanner.ll"
+#line 78 "scanner.ll"
 { yylval->fn = 5; return token::CMP; }
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
-#line 78 "scanner.ll"
+#line 79 "scanner.ll"
 { yylval->fn = 6; return token::CMP; }
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
-#line 80 "scanner.ll"
+#line 81 "scanner.ll"
 { return token::IF; }
 	YY_BREAK
 case 19:
 YY_RULE_SETUP
-#line 81 "scanner.ll"
+#line 82 "scanner.ll"
 { return token::THEN; }
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
-#line 82 "scanner.ll"
+#line 83 "scanner.ll"
 { return token::ELSE; }
 	YY_BREAK
 case 21:
 YY_RULE_SETUP
-#line 83 "scanner.ll"
+#line 84 "scanner.ll"
 { return token::FI; }
 	YY_BREAK
 case 22:
 YY_RULE_SETUP
-#line 84 "scanner.ll"
+#line 85 "scanner.ll"
 { return token::LET; }
 	YY_BREAK
 case 23:
 YY_RULE_SETUP
-#line 86 "scanner.ll"
+#line 87 "scanner.ll"
 { yylval->fn = 1; return token::UNARYFUNC; }
 	YY_BREAK
 case 24:
 YY_RULE_SETUP
-#line 87 "scanner.ll"
+#line 88 "scanner.ll"
 { yylval->fn = 2; return token::UNARYFUNC; }
 	YY_BREAK
 case 25:
 YY_RULE_SETUP
-#line 88 "scanner.ll"
+#line 89 "scanner.ll"
 { yylval->fn = 3; return token::UNARYFUNC; }
 	YY_BREAK
 case 26:
 YY_RULE_SETUP
-#line 89 "scanner.ll"
+#line 90 "scanner.ll"
 { yylval->fn = 4; return token::UNARYFUNC; }
 	YY_BREAK
 case 27:
 YY_RULE_SETUP
-#line 90 "scanner.ll"
+#line 91 "scanner.ll"
 { yylval->fn = 1; return token::BINARYFUNC; }
 	YY_BREAK
 case 28:
 YY_RULE_SETUP
-#line 92 "scanner.ll"
+#line 93 "scanner.ll"
 { yylval->integerVal = atoi(yytext); return token::INTEGER; }
 	YY_BREAK
 case 29:
 YY_RULE_SETUP
-#line 94 "scanner.ll"
+#line 95 "scanner.ll"
 { yylval->doubleVal = atof(yytext); return token::DOUBLE; }
 	YY_BREAK
 /* [A-Za-z][A-Za-z0-9_,.-]* { yylval->stringVal = new std::string(yytext, yyleng); return token::STRING; } */
 case 30:
 YY_RULE_SETUP
-#line 97 "scanner.ll"
-{ yylval->stringVal = new std::string(yytext, yyleng); return token::STRING; }
+#line 98 "scanner.ll"
+{ yylval->symbolVal = calc.intern(yytext, yyleng); return token::STRING; }
 	YY_BREAK
 /* gobble up white-spaces */
 case 31:
 YY_RULE_SETUP
-#line 100 "scanner.ll"
+#line 101 "scanner.ll"
 { yylloc->step(); }
 	YY_BREAK
 /* gobble up end-of-lines */
 case 32:
 /* rule 32 can match eol */
 YY_RULE_SETUP
-#line 103 "scanner.ll"
+#line 104 "scanner.ll"
 { yylloc->lines(yyleng); yylloc->step(); return token::EOL; }
 	YY_BREAK
 /* pass all other characters up to bison */
 case 33:
 YY_RULE_SETUP
-#line 106 "scanner.ll"
+#line 107 "scanner.ll"
 { return static_cast<token_type>(*yytext); }
 	YY_BREAK
 /*** END EXAMPLE - Change the yxlang lexer rules above ***/
 case 34:
 YY_RULE_SETUP
-#line 110 "scanner.ll"
+#line 111 "scanner.ll"
 ECHO;
 	YY_BREAK
-#line 987 "scanner.cc"
+#line 988 "scanner.cc"
 case YY_STATE_EOF(INITIAL):
 	yyterminate();
 
@@ -2023,13 +2024,13 @@ void Yxlangfree (void * ptr )
 
 /* %ok-for-header */
 
-#line 110 "scanner.ll"
+#line 111 "scanner.ll"
 
 
 
 namespace yxlang {
 
-Scanner::Scanner(std::istream* in, std::ostream* out) : YxlangFlexLexer(in, out) {
+Scanner::Scanner(YxlangContext& _calc, std::istream* in, std::ostream* out) : YxlangFlexLexer(in, out), calc(_calc), eager(false) {
 }
 
 Scanner::~Scanner() {
@@ -2039,6 +2040,68 @@ void Scanner::set_debug(bool b) {
     yy_flex_debug = b;
 }
 
+void Scanner::set_eager(bool b) {
+    eager = b;
+}
+
+int Scanner::LexerInput(char* buf, int max_size) {
+    if (!eager)
+        return YxlangFlexLexer::LexerInput(buf, max_size);
+    if (yyin->eof() || yyin->fail())
+        return 0;
+
+    /* wait for one byte at most, then take what is buffered or ready */
+    std::streamsize n = yyin->readsome(buf, max_size);
+    if (n > 0)
+        return n;
+    if (!yyin->get(buf[0]))
+        return 0;
+    n = max_size > 1 ? yyin->readsome(buf + 1, max_size - 1) : 0;
+    return 1 + (n > 0 ? n : 0);
+}
+
+void Scanner::scan_stream(std::istream* in) {
+    if (YY_CURRENT_BUFFER && YY_CURRENT_BUFFER->yy_is_our_buffer) {
+        yyrestart(in);
+    } else {
+        /* the memory of the last scan may be gone, nothing is written back */
+        yy_delete_buffer(YY_CURRENT_BUFFER);
+        yy_switch_to_buffer(yy_create_buffer(in, YY_BUF_SIZE));
+    }
+}
+
+bool Scanner::scan_buffer(char* base, size_t size) {
+    if (size >= static_cast<size_t>(INT_MAX) || base[size] != YY_END_OF_BUFFER_CHAR || base[size + 1] != YY_END_OF_BUFFER_CHAR)
+        return false;
+
+    YY_BUFFER_STATE b = YY_CURRENT_BUFFER;
+    bool reuse = b && !b->yy_is_our_buffer;
+    if (!reuse) {
+        yy_delete_buffer(b);
+        b = (YY_BUFFER_STATE) Yxlangalloc(sizeof(struct yy_buffer_state));
+        if (!b)
+            YY_FATAL_ERROR("out of dynamic memory in scan_buffer()");
+    }
+    b->yy_buf_size = size;
+    b->yy_buf_pos = b->yy_ch_buf = base;
+    b->yy_is_our_buffer = 0;
+    b->yy_input_file = 0;
+    b->yy_n_chars = b->yy_buf_size;
+    b->yy_is_interactive = 0;
+    b->yy_at_bol = 1;
+    b->yy_bs_lineno = 1;
+    b->yy_bs_column = 0;
+    b->yy_fill_buffer = 0;
+    b->yy_buffer_status = YY_BUFFER_NEW;
+
+    /* a buffer left from the last scan is not flushed, its memory may be gone */
+    if (reuse)
+        yy_load_buffer_state();
+    else
+        yy_switch_to_buffer(b);
+    return true;
+}
+
 }
 
 /* This implementation of YxlangFlexLexer::yylex() is required to fill the
@@ -27,8 +27,11 @@
 #undef yyFlexLexer
 #endif
 
+#include <limits.h>
 #include "parser.h"
 
+class YxlangContext;
+
 namespace yxlang {
 
 /** Scanner is a derived class to add some extra function to the scanner
@@ -40,11 +43,11 @@ namespace yxlang {
 class Scanner : public YxlangFlexLexer
 {
 public:
-    /** Create a new scanner object. The streams arg_yyin and arg_yyout default
-     * to cin and cout, but that assignment is only made when initializing in
-     * yylex(). 
+    /** Create a new scanner object. Names are interned in the symbols of
+     * calc. The streams arg_yyin and arg_yyout default to cin and cout, but
+     * that assignment is only made when initializing in yylex(). 
      */
-    Scanner(std::istream* arg_yyin = 0, std::ostream* arg_yyout = 0);
+    Scanner(YxlangContext& calc, std::istream* arg_yyin = 0, std::ostream* arg_yyout = 0);
 
     /** Required for virtual functions */
     virtual ~Scanner();
@@ -57,6 +60,29 @@ public:
 
     /** Enable debug output (via arg_yyout) if compiled into the scanner. */
     void set_debug(bool b);
+
+    /** Scan the stream in next, reusing the buffer of the last stream. */
+    void scan_stream(std::istream* in);
+
+    /** Scan size bytes at base in place, like yy_scan_buffer() of a C
+     * scanner. base[size] and base[size + 1] have to be 0, size less than
+     * INT_MAX. Tokens are taken straight from the memory, which is
+     * modified while scanning and has to stay until the scan is done.
+     * Returns false if the bytes do not fit. */
+    bool scan_buffer(char* base, size_t size);
+
+    /** Hand on what a stream has as soon as it has any, instead of waiting
+     * for a full buffer, so statements coming down a pipe are seen right
+     * away. The scanner looks one character ahead, so a line is done once
+     * the next one starts. */
+    void set_eager(bool b);
+
+protected:
+    virtual int LexerInput(char* buf, int max_size);
+
+private:
+    YxlangContext& calc;
+    bool eager;
 };
 
 } // namespace yxlang
@@ -9,6 +9,7 @@
 
 #include <string>
 #include "scanner.h"
+#include "expression.h"
 
 /* import the parser's token type into a local typedef */
 typedef yxlang::Parser::token token;
@@ -94,7 +95,7 @@ typedef yxlang::Parser::token_type token_type;
 [0-9]+"."[0-9]* { yylval->doubleVal = atof(yytext); return token::DOUBLE; }
 
  /* [A-Za-z][A-Za-z0-9_,.-]* { yylval->stringVal = new std::string(yytext, yyleng); return token::STRING; } */
-[A-Za-z][A-Za-z0-9_.-]* { yylval->stringVal = new std::string(yytext, yyleng); return token::STRING; }
+[A-Za-z][A-Za-z0-9_.-]* { yylval->symbolVal = calc.intern(yytext, yyleng); return token::STRING; }
 
  /* gobble up white-spaces */
 [ \t\r]+ { yylloc->step(); }
@@ -111,7 +112,7 @@ typedef yxlang::Parser::token_type token_type;
 
 namespace yxlang {
 
-Scanner::Scanner(std::istream* in, std::ostream* out) : YxlangFlexLexer(in, out) {
+Scanner::Scanner(YxlangContext& _calc, std::istream* in, std::ostream* out) : YxlangFlexLexer(in, out), calc(_calc), eager(false) {
 }
 
 Scanner::~Scanner() {
@@ -121,6 +122,68 @@ void Scanner::set_debug(bool b) {
     yy_flex_debug = b;
 }
 
+void Scanner::set_eager(bool b) {
+    eager = b;
+}
+
+int Scanner::LexerInput(char* buf, int max_size) {
+    if (!eager)
+        return YxlangFlexLexer::LexerInput(buf, max_size);
+    if (yyin->eof() || yyin->fail())
+        return 0;
+
+    /* wait for one byte at most, then take what is buffered or ready */
+    std::streamsize n = yyin->readsome(buf, max_size);
+    if (n > 0)
+        return n;
+    if (!yyin->get(buf[0]))
+        return 0;
+    n = max_size > 1 ? yyin->readsome(buf + 1, max_size - 1) : 0;
+    return 1 + (n > 0 ? n : 0);
+}
+
+void Scanner::scan_stream(std::istream* in) {
+    if (YY_CURRENT_BUFFER && YY_CURRENT_BUFFER->yy_is_our_buffer) {
+        yyrestart(in);
+    } else {
+        /* the memory of the last scan may be gone, nothing is written back */
+        yy_delete_buffer(YY_CURRENT_BUFFER);
+        yy_switch_to_buffer(yy_create_buffer(in, YY_BUF_SIZE));
+    }
+}
+
+bool Scanner::scan_buffer(char* base, size_t size) {
+    if (size >= static_cast<size_t>(INT_MAX) || base[size] != YY_END_OF_BUFFER_CHAR || base[size + 1] != YY_END_OF_BUFFER_CHAR)
+        return false;
+
+    YY_BUFFER_STATE b = YY_CURRENT_BUFFER;
+    bool reuse = b && !b->yy_is_our_buffer;
+    if (!reuse) {
+        yy_delete_buffer(b);
+        b = (YY_BUFFER_STATE) Yxlangalloc(sizeof(struct yy_buffer_state));
+        if (!b)
+            YY_FATAL_ERROR("out of dynamic memory in scan_buffer()");
+    }
+    b->yy_buf_size = size;
+    b->yy_buf_pos = b->yy_ch_buf = base;
+    b->yy_is_our_buffer = 0;
+    b->yy_input_file = 0;
+    b->yy_n_chars = b->yy_buf_size;
+    b->yy_is_interactive = 0;
+    b->yy_at_bol = 1;
+    b->yy_bs_lineno = 1;
+    b->yy_bs_column = 0;
+    b->yy_fill_buffer = 0;
+    b->yy_buffer_status = YY_BUFFER_NEW;
+
+    /* a buffer left from the last scan is not flushed, its memory may be gone */
+    if (reuse)
+        yy_load_buffer_state();
+    else
+        yy_switch_to_buffer(b);
+    return true;
+}
+
 }
 
 /* This implementation of YxlangFlexLexer::yylex() is required to fill the
@@ -0,0 +1,131 @@
+/**
+ * @file cachetest.cc
+ * @brief parse cache of the driver: hits, least recently used replacement,
+ * and optimized entries parsed again once a function they call changes
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <iostream>
+#include <string>
+#include "driver.h"
+#include "expression.h"
+#include "optimizer.h"
+#include "parsecache.h"
+
+namespace {
+
+bool failed = false;
+
+void expect(const std::string &what, double got, double wanted) {
+    if (got != wanted) {
+        std::cerr << what << ": " << got << ", expected " << wanted << std::endl;
+        failed = true;
+    }
+}
+
+/** parse text and evaluate it, returns its value */
+double run(YxlangContext &calc, yxlang::Driver &driver, const std::string &text) {
+    if (!driver.parse_string(text, "cachetest")) {
+        std::cerr << text << ": syntax error" << std::endl;
+        failed = true;
+        return 0;
+    }
+    return calc.evaluate(static_cast<unsigned int>(calc.expressions.size() - 1));
+}
+
+/** the counters of the cache after text */
+void counts(yxlang::Driver &driver, const std::string &text, unsigned long hits, unsigned long misses, unsigned long stale) {
+    const YxlangParseCache* cache = driver.getCache();
+    expect(text + ", hits", cache->hits, hits);
+    expect(text + ", misses", cache->misses, misses);
+    expect(text + ", stale", cache->stale, stale);
+}
+
+void hits() {
+    YxlangContext calc;
+    yxlang::Driver driver(calc);
+    driver.setCache(2);
+    calc.setVariable("x", 2);
+    expect("x + 1", run(calc, driver, "x + 1\n"), 3);
+    const YxlangNode* first = calc.expressions.back();
+    expect("x + 1 again", run(calc, driver, "x + 1\n"), 3);
+    counts(driver, "x + 1 again", 1, 1, 0);
+    if (calc.expressions.back() != first) {
+        std::cerr << "a hit parsed x + 1 again" << std::endl;
+        failed = true;
+    }
+
+    /* the nodes read the variable, not its value when parsed */
+    calc.setVariable("x", 5);
+    expect("x + 1 after x = 5", run(calc, driver, "x + 1\n"), 6);
+    counts(driver, "x + 1 after x = 5", 2, 1, 0);
+
+    /* a definition has to stay, it is not cached */
+    run(calc, driver, "let g(a) = a;\n");
+    run(calc, driver, "let g(a) = a;\n");
+    counts(driver, "let g twice", 2, 3, 0);
+    expect("size after definitions", driver.getCache()->size(), 1);
+}
+
+void replacement() {
+    YxlangContext calc;
+    yxlang::Driver driver(calc);
+    driver.setCache(2);
+    run(calc, driver, "1\n");
+    run(calc, driver, "2\n");
+    /* 1 is used again, so 2 is the least recently used */
+    run(calc, driver, "1\n");
+    run(calc, driver, "3\n");
+    counts(driver, "1 2 1 3", 1, 3, 0);
+    expect("size when full", driver.getCache()->size(), 2);
+    expect("1", run(calc, driver, "1\n"), 1);
+    counts(driver, "1 after 3", 2, 3, 0);
+    expect("2", run(calc, driver, "2\n"), 2);
+    counts(driver, "2 after 3", 2, 4, 0);
+
+    driver.setCache(1);
+    expect("size after shrinking", driver.getCache()->size(), 1);
+    expect("2 after shrinking", run(calc, driver, "2\n"), 2);
+    counts(driver, "2 after shrinking", 3, 4, 0);
+}
+
+void callees() {
+    YxlangContext calc;
+    yxlang::Driver driver(calc);
+    driver.setCache(4);
+    driver.optimize_level = OPTIMIZE_SAFE;
+    run(calc, driver, "let f(a) = a + 1;\n");
+    expect("f(2)", run(calc, driver, "f(2)\n"), 3);
+    expect("f(2) again", run(calc, driver, "f(2)\n"), 3);
+    counts(driver, "f(2) again", 1, 2, 0);
+
+    /* the body of the old f is inlined in the entry */
+    run(calc, driver, "let f(a) = a * 10;\n");
+    expect("f(2) after redefining f", run(calc, driver, "f(2)\n"), 20);
+    counts(driver, "f(2) after redefining f", 1, 4, 1);
+    expect("f(2) parsed again", run(calc, driver, "f(2)\n"), 20);
+    counts(driver, "f(2) parsed again", 2, 4, 1);
+
+    /* another level is another parse */
+    driver.optimize_level = OPTIMIZE_NONE;
+    expect("f(2) unoptimized", run(calc, driver, "f(2)\n"), 20);
+    counts(driver, "f(2) unoptimized", 2, 5, 2);
+
+    /* unoptimized nodes call f by name */
+    run(calc, driver, "let f(a) = a - 1;\n");
+    expect("f(2) unoptimized after redefining f", run(calc, driver, "f(2)\n"), 1);
+    counts(driver, "f(2) unoptimized after redefining f", 3, 6, 2);
+}
+
+} // namespace
+
+int main() {
+    hits();
+    replacement();
+    callees();
+    if (failed)
+        return 1;
+    std::cout << "cachetest: ok" << std::endl;
+    return 0;
+}
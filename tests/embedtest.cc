@@ -0,0 +1,113 @@
+/**
+ * @file embedtest.cc
+ * @brief embedding API: bound host variables, also in the functions a
+ * program calls, unbinding, and programs outliving a growing variable
+ * array
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <iostream>
+#include <string>
+#include "embed.h"
+
+namespace {
+
+bool failed = false;
+
+void expect(const std::string &what, double got, double wanted) {
+    if (got != wanted) {
+        std::cerr << what << ": " << got << ", expected " << wanted << std::endl;
+        failed = true;
+    }
+}
+
+void bind() {
+    yxlang::Compiler compiler;
+    double x = 2, y = 0;
+    compiler.bind("x", &x);
+    compiler.bind("y", &y);
+    yxlang::Program p = compiler.compile("y = x * 3\ny + 1\n");
+    expect("y = x * 3", p.eval(), 7);
+    expect("host y", y, 6);
+    expect("context y", compiler.calc.getVariable("y"), 0);
+
+    /* the program reads the host variable each time */
+    x = 5;
+    expect("after x = 5", p.eval(), 16);
+    expect("host y after x = 5", y, 15);
+
+    /* programs compiled before keep their bindings */
+    compiler.bind("x", NULL);
+    compiler.calc.setVariable("x", 100);
+    yxlang::Program q = compiler.compile("x + 1\n");
+    expect("unbound x", q.eval(), 101);
+    expect("bound x after unbinding", p.eval(), 16);
+}
+
+void functions() {
+    yxlang::Compiler compiler;
+    double x = 6, y = 0;
+    compiler.bind("x", &x);
+    compiler.bind("y", &y);
+    compiler.compile("let g(a) = x + a;\n").eval();
+    compiler.compile("let h(a) = y = a * 2;\n").eval();
+
+    /* the bodies read and assign the host variables */
+    yxlang::Program p = compiler.compile("g(1)\n");
+    yxlang::Program q = compiler.compile("h(x) + y\n");
+    x = 10;
+    expect("g(1)", p.eval(), 11);
+    expect("h(x) + y", q.eval(), 40);
+    expect("host y", y, 20);
+    expect("context y", compiler.calc.getVariable("y"), 0);
+
+    /* each program has its own bindings */
+    double other = 100;
+    compiler.bind("x", &other);
+    yxlang::Program r = compiler.compile("g(1)\n");
+    expect("g(1) with x at other", r.eval(), 101);
+    expect("g(1) with x at x", p.eval(), 11);
+
+    /* with none, the bodies see the context */
+    compiler.bind("x", NULL);
+    compiler.calc.setVariable("x", 1000);
+    expect("g(1) with x unbound", compiler.compile("g(1)\n").eval(), 1001);
+}
+
+void growth() {
+    yxlang::Compiler compiler;
+    double x = 1;
+    compiler.bind("x", &x);
+    yxlang::Program p = compiler.compile("w = x + 2\nw * 2\n");
+    yxlang::Program q = compiler.compile("w + 1\n");
+    expect("w * 2", p.eval(), 6);
+
+    /* each compile adds a slot, the array moves a few times */
+    const double* before = compiler.calc.variables.data();
+    for (int i = 0; i < 1000; ++i)
+        compiler.compile("v" + std::to_string(i) + " = 1\n");
+    if (compiler.calc.variables.data() == before) {
+        std::cerr << "the variable array did not move" << std::endl;
+        failed = true;
+    }
+
+    x = 4;
+    expect("w * 2 after growing", p.eval(), 12);
+    expect("w + 1 after growing", q.eval(), 7);
+    expect("context w", compiler.calc.getVariable("w"), 6);
+    yxlang::Program r = compiler.compile("w + v999\n");
+    expect("w + v999", r.eval(), 6);
+}
+
+} // namespace
+
+int main() {
+    bind();
+    functions();
+    growth();
+    if (failed)
+        return 1;
+    std::cout << "embedtest: ok" << std::endl;
+    return 0;
+}
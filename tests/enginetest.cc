@@ -0,0 +1,198 @@
+/**
+ * @file enginetest.cc
+ * @brief runs random scripts on every engine, optimized or not, streamed
+ * or not, and checks they all agree with the tree walker
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "driver.h"
+#include "expression.h"
+#include "optimizer.h"
+
+namespace {
+
+enum {
+    NVARS = 6,
+    NFUNCS = 3
+};
+
+uint64_t state = 88172645463325252ULL;
+
+/** xorshift, the same scripts on every run */
+unsigned int random(unsigned int n) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return static_cast<unsigned int>(state % n);
+}
+
+/** writes random scripts. Every subexpression is in parentheses, a
+ * function only calls those defined before it, so every script ends. */
+class Generator {
+public:
+    Generator() : nfuncs(0) {
+    }
+
+    std::string script(unsigned int nstatements) {
+        std::ostringstream os;
+        nfuncs = 0;
+        for (unsigned int v = 0; v < NVARS; ++v)
+            os << "v" << v << " = " << random(10) << "\n";
+        for (unsigned int i = 0; i < nstatements; ++i)
+            os << statement(false) << "\n";
+        return os.str();
+    }
+
+private:
+    /// functions defined so far
+    unsigned int	nfuncs;
+
+    std::string statement(bool body) {
+        std::ostringstream os;
+        unsigned int kind = random(10);
+        if (!body && kind == 0 && nfuncs < NFUNCS) {
+            /* defined after the body, so it cannot call itself */
+            std::string list = sentences(true);
+            os << "let f" << nfuncs++ << "(a, b) = " << list;
+        } else if (kind <= 2) {
+            os << "if " << expr(2, body) << " then " << sentences(body) << " else " << sentences(body) << " fi";
+        } else if (kind <= 6) {
+            os << "v" << random(NVARS) << " = " << expr(3, body);
+        } else {
+            os << expr(3, body);
+        }
+        return os.str();
+    }
+
+    std::string sentences(bool body) {
+        std::string list;
+        unsigned int n = 1 + random(2);
+        for (unsigned int i = 0; i < n; ++i)
+            list += statement(body) + "; ";
+        return list;
+    }
+
+    std::string expr(unsigned int depth, bool body) {
+        std::ostringstream os;
+        unsigned int kind = depth ? random(12) : random(3);
+        static const char* const ops[] = { "+", "-", "*", "/", "%", ">", "<", "<>", "==", ">=", "<=" };
+        static const char* const unary[] = { "sqrt", "exp", "log" };
+        switch (kind) {
+            case 0:
+                os << random(20);
+                break;
+            case 1:
+                os << random(100) << "." << random(100);
+                break;
+            case 2:
+                if (body && random(2))
+                    os << (random(2) ? "a" : "b");
+                else
+                    os << "v" << random(NVARS);
+                break;
+            case 3:
+                os << unary[random(3)] << "(" << expr(depth - 1, body) << ")";
+                break;
+            case 4:
+                os << "pow(" << expr(depth - 1, body) << ", " << expr(depth - 1, body) << ")";
+                break;
+            case 5:
+                if (nfuncs) {
+                    os << "f" << random(nfuncs) << "(" << expr(depth - 1, body);
+                    if (random(3))
+                        os << ", " << expr(depth - 1, body);
+                    os << ")";
+                    break;
+                }
+                /* fall through */
+            default:
+                os << "(" << expr(depth - 1, body) << " " << ops[random(11)] << " " << expr(depth - 1, body) << ")";
+                break;
+        }
+        return os.str();
+    }
+};
+
+/** what a run leaves behind */
+struct Outcome {
+    double	value;
+    double	vars[NVARS];
+};
+
+bool same(double a, double b) {
+    return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+bool run(const std::string &script, YxlangEngine engine, int level, bool streaming, Outcome &outcome) {
+    YxlangContext calc;
+    calc.setEngine(engine);
+    yxlang::Driver driver(calc);
+    driver.optimize_level = level;
+    driver.streaming = streaming;
+    outcome.value = 0;
+    driver.executed = [&outcome](const YxlangNode*, double v) {
+        outcome.value = v;
+    };
+    if (!driver.parse_string(script, "script"))
+        return false;
+    if (!streaming)
+        outcome.value = calc.evaluate(0);
+    for (unsigned int v = 0; v < NVARS; ++v) {
+        std::ostringstream name;
+        name << "v" << v;
+        outcome.vars[v] = calc.getVariable(name.str());
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    unsigned int nscripts = argc > 1 ? strtoul(argv[1], NULL, 10) : 300;
+    static const YxlangEngine engines[] = { ENGINE_TREE, ENGINE_STACK, ENGINE_REGISTER, ENGINE_JIT, ENGINE_CLOSURE, ENGINE_FLAT };
+    static const char* const names[] = { "tree", "stack", "register", "jit", "closure", "flat" };
+    Generator generator;
+    unsigned int failures = 0;
+    for (unsigned int s = 0; s < nscripts; ++s) {
+        std::string script = generator.script(5 + random(20));
+        Outcome expected;
+        if (!run(script, ENGINE_TREE, OPTIMIZE_NONE, false, expected)) {
+            std::cerr << "enginetest: script " << s << " does not parse:" << std::endl << script;
+            return 1;
+        }
+        for (unsigned int e = 0; e < sizeof(engines) / sizeof(engines[0]); ++e) {
+            for (int level = OPTIMIZE_NONE; level <= OPTIMIZE_SAFE; ++level) {
+                for (int streaming = 0; streaming < 2; ++streaming) {
+                    Outcome got;
+                    std::ostringstream what;
+                    if (!run(script, engines[e], level, streaming, got))
+                        what << "does not parse";
+                    else if (!same(got.value, expected.value))
+                        what << "value " << got.value << " instead of " << expected.value;
+                    for (unsigned int v = 0; what.str().empty() && v < NVARS; ++v) {
+                        if (!same(got.vars[v], expected.vars[v]))
+                            what << "v" << v << " " << got.vars[v] << " instead of " << expected.vars[v];
+                    }
+                    if (!what.str().empty() && failures++ < 5) {
+                        std::cerr << "enginetest: script " << s << " differs on " << names[e] << (level ? " -O" : "") << (streaming ? " streaming" : "")
+                                  << ", " << what.str() << ":" << std::endl << script;
+                    }
+                }
+            }
+        }
+    }
+    if (failures) {
+        std::cerr << "enginetest: " << failures << " runs differ" << std::endl;
+        return 1;
+    }
+    std::cout << "enginetest: " << nscripts << " scripts agree on all engines" << std::endl;
+    return 0;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file inlinetest.cc
+ * @brief inlined calls on every engine have to see a function redefined
+ * after they were optimized and compiled
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <iostream>
+#include <string>
+#include "driver.h"
+#include "expression.h"
+#include "optimizer.h"
+
+namespace {
+
+bool failed = false;
+
+/** true if node has an inlined call below it */
+bool guarded(const YxlangNode* node) {
+    if (!node)
+        return false;
+    if (node->type() == NT_GUARD)
+        return true;
+    YxlangNode::Children children(node);
+    for (unsigned int i = 0; i < children.size(); ++i) {
+        if (guarded(children[i]))
+            return true;
+    }
+    return false;
+}
+
+/** parse text and return the index of its expression */
+unsigned int parse(YxlangContext &calc, yxlang::Driver &driver, const std::string &text) {
+    if (!driver.parse_string(text, "inlinetest")) {
+        std::cerr << text << ": syntax error" << std::endl;
+        failed = true;
+    }
+    return static_cast<unsigned int>(calc.expressions.size() - 1);
+}
+
+void expect(const std::string &what, double got, double wanted) {
+    if (got != wanted) {
+        std::cerr << what << ": " << got << ", expected " << wanted << std::endl;
+        failed = true;
+    }
+}
+
+/** f inlined into a statement and into the body of g, then redefined */
+void redefine(YxlangEngine engine, const std::string &name) {
+    YxlangContext calc;
+    calc.setEngine(engine);
+    yxlang::Driver driver(calc);
+    driver.optimize_level = OPTIMIZE_SAFE;
+    calc.evaluate(parse(calc, driver, "let f(a) = a + 1;\nlet g(a) = f(a) * 2;\n"));
+    unsigned int call = parse(calc, driver, "y = f(2)\n");
+    unsigned int nested = parse(calc, driver, "g(2)\n");
+    if (!guarded(calc.expressions[call]) || !guarded(calc.getFunction(calc.getSlot("g"))->right)) {
+        std::cerr << name << ": f is not inlined" << std::endl;
+        failed = true;
+    }
+    expect(name + ": f(2)", calc.evaluate(call), 3);
+    expect(name + ": g(2)", calc.evaluate(nested), 6);
+
+    /* the compiled programs are kept, their guards have to fail now */
+    calc.evaluate(parse(calc, driver, "let f(a) = a * 10;\n"));
+    expect(name + ": f(2) after redefining f", calc.evaluate(call), 20);
+    expect(name + ": y", calc.getVariable("y"), 20);
+    expect(name + ": g(2) after redefining f", calc.evaluate(nested), 40);
+
+    /* and hold again for the calls inlined from the new definition */
+    unsigned int again = parse(calc, driver, "f(3)\n");
+    expect(name + ": f(3) inlined from the new f", calc.evaluate(again), 30);
+    calc.evaluate(parse(calc, driver, "let f(a) = a - 1;\n"));
+    expect(name + ": f(3) after redefining f twice", calc.evaluate(again), 2);
+}
+
+/** a definition later in the same text is the one inlined after it */
+void sameText(YxlangEngine engine, const std::string &name) {
+    YxlangContext calc;
+    calc.setEngine(engine);
+    yxlang::Driver driver(calc);
+    driver.optimize_level = OPTIMIZE_SAFE;
+    unsigned int index = parse(calc, driver, "let f(a) = a + 1;\nu = f(1)\nlet f(a) = a + 2;\nu + f(1)\n");
+    expect(name + ": one text", calc.evaluate(index), 5);
+}
+
+} // namespace
+
+int main() {
+    static const YxlangEngine engines[] = { ENGINE_TREE, ENGINE_STACK, ENGINE_REGISTER, ENGINE_JIT, ENGINE_CLOSURE, ENGINE_FLAT };
+    static const char* const names[] = { "tree", "stack", "register", "jit", "closure", "flat" };
+    for (unsigned int e = 0; e < sizeof(engines) / sizeof(engines[0]); ++e) {
+        redefine(engines[e], names[e]);
+        sameText(engines[e], names[e]);
+    }
+    if (failed)
+        return 1;
+    std::cout << "inlinetest: ok" << std::endl;
+    return 0;
+}
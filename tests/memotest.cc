@@ -0,0 +1,114 @@
+/**
+ * @file memotest.cc
+ * @brief result cache of user defined functions: hits and misses,
+ * replacement when full, and what a redefinition throws away
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <iostream>
+#include <string>
+#include "driver.h"
+#include "expression.h"
+#include "memo.h"
+
+namespace {
+
+bool failed = false;
+
+/** parse text and evaluate its expressions, returns the last value */
+double run(YxlangContext &calc, yxlang::Driver &driver, const std::string &text) {
+    size_t first = calc.expressions.size();
+    if (!driver.parse_string(text, "memotest")) {
+        std::cerr << text << ": syntax error" << std::endl;
+        failed = true;
+        return 0;
+    }
+    double v = 0;
+    for (size_t i = first; i < calc.expressions.size(); ++i)
+        v = calc.evaluate(static_cast<unsigned int>(i));
+    return v;
+}
+
+void expect(const std::string &what, double got, double wanted) {
+    if (got != wanted) {
+        std::cerr << what << ": " << got << ", expected " << wanted << std::endl;
+        failed = true;
+    }
+}
+
+/** result of text, with the hits and misses of the cache of name after it */
+void call(YxlangContext &calc, yxlang::Driver &driver, const std::string &text, double value, const std::string &name, unsigned long hits, unsigned long misses) {
+    expect(text, run(calc, driver, text), value);
+    const YxlangMemo* memo = calc.getMemo(calc.getSlot(name));
+    if (!memo) {
+        std::cerr << text << ": " << name << " has no cache" << std::endl;
+        failed = true;
+        return;
+    }
+    expect(text + ", hits of " + name, memo->hits, hits);
+    expect(text + ", misses of " + name, memo->misses, misses);
+}
+
+void counts() {
+    YxlangContext calc;
+    yxlang::Driver driver(calc);
+    calc.setMemoize(2);
+    run(calc, driver, "let sq(a) = a * a;\n");
+    call(calc, driver, "sq(3)\n", 9, "sq", 0, 1);
+    call(calc, driver, "sq(3)\n", 9, "sq", 1, 1);
+    /* 0 and -0 are different arguments */
+    call(calc, driver, "z = 0\nsq(z * (0 - 1))\n", 0, "sq", 1, 2);
+    call(calc, driver, "sq(0)\n", 0, "sq", 1, 3);
+}
+
+void eviction() {
+    YxlangContext calc;
+    yxlang::Driver driver(calc);
+    calc.setMemoize(2);
+    run(calc, driver, "let sq(a) = a * a;\n");
+    call(calc, driver, "sq(3)\n", 9, "sq", 0, 1);
+    call(calc, driver, "sq(3)\n", 9, "sq", 1, 1);
+    call(calc, driver, "sq(4)\n", 16, "sq", 1, 2);
+    /* full, the hand passes over 3, which was hit, and replaces 4 */
+    call(calc, driver, "sq(5)\n", 25, "sq", 1, 3);
+    expect("size when full", calc.getMemo(calc.getSlot("sq"))->size(), 2);
+    call(calc, driver, "sq(3)\n", 9, "sq", 2, 3);
+    call(calc, driver, "sq(5)\n", 25, "sq", 3, 3);
+    call(calc, driver, "sq(4)\n", 16, "sq", 3, 4);
+}
+
+void invalidation() {
+    YxlangContext calc;
+    yxlang::Driver driver(calc);
+    calc.setMemoize(16);
+    run(calc, driver, "let sq(a) = a * a;\nlet g(a) = sq(a) + 1;\n");
+    call(calc, driver, "g(2)\n", 5, "g", 0, 1);
+    call(calc, driver, "g(2)\n", 5, "g", 1, 1);
+    /* the cached result of g used the old sq */
+    run(calc, driver, "let sq(a) = a * 3;\n");
+    call(calc, driver, "g(2)\n", 7, "g", 0, 1);
+    call(calc, driver, "g(2)\n", 7, "g", 1, 1);
+
+    /* reading a global makes a function impure, it is never cached */
+    run(calc, driver, "x = 1\nlet h(a) = a + x;\n");
+    expect("h(1)", run(calc, driver, "h(1)\n"), 2);
+    run(calc, driver, "x = 2\n");
+    expect("h(1) after x = 2", run(calc, driver, "h(1)\n"), 3);
+    if (calc.getMemo(calc.getSlot("h"))) {
+        std::cerr << "h reads x but has a cache" << std::endl;
+        failed = true;
+    }
+}
+
+} // namespace
+
+int main() {
+    counts();
+    eviction();
+    invalidation();
+    if (failed)
+        return 1;
+    std::cout << "memotest: ok" << std::endl;
+    return 0;
+}
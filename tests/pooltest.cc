@@ -0,0 +1,100 @@
+/**
+ * @file pooltest.cc
+ * @brief thread pool stress test, built with ThreadSanitizer by make check
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <map>
+#include "threadpool.h"
+#include "driver.h"
+#include "expression.h"
+#include "batch.h"
+
+namespace {
+
+uint64_t state = 88172645463325252ULL;
+
+/** xorshift, the same sequence on every run */
+uint64_t next() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+/** runs of random sizes and morsels, every index has to be handled
+ * exactly once */
+bool stress(unsigned int nthreads, unsigned int runs) {
+    YxlangThreadPool pool(nthreads);
+    for (unsigned int i = 0; i < runs; ++i) {
+        size_t n = next() % 100000;
+        size_t morsel = 1 + next() % 2000;
+        std::vector<std::atomic<unsigned int> > handled(n);
+        for (size_t k = 0; k < n; ++k)
+            handled[k] = 0;
+        std::atomic<bool> outside(false);
+        pool.run(n, morsel, [&](size_t begin, size_t end) {
+            if (begin >= end || end > n)
+                outside = true;
+            for (size_t k = begin; k < end && k < n; ++k)
+                ++handled[k];
+        });
+        if (outside) {
+            std::cerr << nthreads << " threads, n " << n << ", morsel " << morsel << ": range outside [0, n)" << std::endl;
+            return false;
+        }
+        for (size_t k = 0; k < n; ++k) {
+            if (handled[k] != 1) {
+                std::cerr << nthreads << " threads, n " << n << ", morsel " << morsel << ": index " << k << " handled " << handled[k] << " times" << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/** a batch on several threads has to give the bits of one thread */
+bool batch(unsigned int nthreads) {
+    const size_t nrows = 5 * BatchProgram::MORSEL + 123;
+    std::vector<double> xs(nrows), ys(nrows);
+    for (size_t r = 0; r < nrows; ++r) {
+        xs[r] = static_cast<double>(next() % 100000) / 1000 - 50;
+        ys[r] = static_cast<double>(next() % 100000) / 1000;
+    }
+    std::map<std::string, const double*> columns;
+    columns["x"] = &xs[0];
+    columns["y"] = &ys[0];
+
+    std::vector<double> out[2];
+    for (unsigned int t = 0; t < 2; ++t) {
+        YxlangContext calc;
+        yxlang::Driver driver(calc);
+        driver.parse_string("z = sqrt(y) * x\nif x > 0 then exp(x / 10) + z; else log(y + 1) - pow(y, 0.5) * z; fi");
+        calc.setThreads(t ? nthreads : 1);
+        out[t].resize(nrows);
+        calc.evaluateBatch(0, columns, nrows, &out[t][0]);
+    }
+    if (memcmp(&out[0][0], &out[1][0], nrows * sizeof(double)) != 0) {
+        std::cerr << nthreads << " threads: batch differs from one thread" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    unsigned int threads[] = { 2, 3, 4, 8 };
+    for (unsigned int i = 0; i < sizeof(threads) / sizeof(threads[0]); ++i) {
+        if (!stress(threads[i], 200) || !batch(threads[i]))
+            return 1;
+    }
+    std::cout << "pooltest: ok" << std::endl;
+    return 0;
+}
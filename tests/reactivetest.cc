@@ -0,0 +1,114 @@
+/**
+ * @file reactivetest.cc
+ * @brief reactive mode re-runs the statements a change reaches, or all of
+ * them when the statements are not like the cells of a spreadsheet
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <iostream>
+#include <string>
+#include "driver.h"
+#include "expression.h"
+#include "reactive.h"
+
+namespace {
+
+bool failed = false;
+
+void expect(const std::string &what, double got, double wanted) {
+    if (got != wanted) {
+        std::cerr << what << ": " << got << ", expected " << wanted << std::endl;
+        failed = true;
+    }
+}
+
+/** parse and run text once, then turn reactive mode on */
+void load(YxlangContext &calc, yxlang::Driver &driver, const std::string &text) {
+    if (!driver.parse_string(text, "reactivetest")) {
+        std::cerr << text << ": syntax error" << std::endl;
+        failed = true;
+        return;
+    }
+    for (size_t i = 0; i < calc.expressions.size(); ++i)
+        calc.evaluate(static_cast<unsigned int>(i));
+    calc.setReactive(true);
+}
+
+/** set name to value, which has to re-run that many statements */
+void update(YxlangContext &calc, const std::string &name, double value, size_t statements) {
+    std::string what = name + " = " + std::to_string(value);
+    expect(what + ", statements run", calc.update(calc.getSlot(name), value), statements);
+    expect(what, calc.getVariable(name), value);
+}
+
+void spreadsheet() {
+    YxlangContext calc;
+    yxlang::Driver driver(calc);
+    load(calc, driver, "a = 1\nb = a * 2\nc = b + 1\nd = 5\ne = d + c\ns = a > 0\nt = s + 10\n");
+
+    /* b, c, e and s read a, t is left alone since s stays 1 */
+    update(calc, "a", 3, 4);
+    if (!calc.getReactive()->isLinear()) {
+        std::cerr << "spreadsheet: not linear" << std::endl;
+        failed = true;
+    }
+    expect("b", calc.getVariable("b"), 6);
+    expect("c", calc.getVariable("c"), 7);
+    expect("e", calc.getVariable("e"), 12);
+    expect("t", calc.getVariable("t"), 11);
+
+    update(calc, "d", 1, 1);
+    expect("e after d", calc.getVariable("e"), 8);
+
+    /* now s changes, and t follows */
+    update(calc, "a", -1, 5);
+    expect("e after a = -1", calc.getVariable("e"), 0);
+    expect("t after a = -1", calc.getVariable("t"), 10);
+
+    /* assigning the variable a statement assigns keeps the new value */
+    update(calc, "c", 100, 1);
+    expect("c kept", calc.getVariable("c"), 100);
+    expect("e after c", calc.getVariable("e"), 101);
+
+    /* nothing reads x */
+    update(calc, "x", 1, 0);
+    expect("statements run in all", calc.getReactive()->evaluated, 11);
+}
+
+void functions() {
+    YxlangContext calc;
+    yxlang::Driver driver(calc);
+    load(calc, driver, "k = 2\nlet scale(v) = v * k;\nw = 3\nr = scale(w)\n");
+    /* r reads k through scale */
+    update(calc, "k", 5, 1);
+    expect("r", calc.getVariable("r"), 15);
+    update(calc, "w", 4, 1);
+    expect("r after w", calc.getVariable("r"), 20);
+}
+
+void fallback() {
+    YxlangContext calc;
+    yxlang::Driver driver(calc);
+    load(calc, driver, "n = 1\nn = n + 1\nm = k * 2\nq = 7\n");
+    /* every statement runs again, those assigning k would not */
+    update(calc, "k", 4, 4);
+    if (calc.getReactive()->isLinear()) {
+        std::cerr << "fallback: n is assigned twice but the graph is linear" << std::endl;
+        failed = true;
+    }
+    expect("n", calc.getVariable("n"), 2);
+    expect("m", calc.getVariable("m"), 8);
+}
+
+} // namespace
+
+int main() {
+    spreadsheet();
+    functions();
+    fallback();
+    if (failed)
+        return 1;
+    std::cout << "reactivetest: ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file ulptest.cc
+ * @brief checks the SIMD column kernels against the error bounds in vecmath.h
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "vecmath.h"
+
+namespace {
+
+enum {
+    CHUNK = 4096
+};
+
+uint64_t state = 88172645463325252ULL;
+
+/** uniform in [0, 1), the same sequence on every run */
+double uniform() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return static_cast<double>(state >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/** error of v in units in the last place of the exact result */
+double ulps(double v, long double exact) {
+    if (std::isnan(v) && std::isnan(exact))
+        return 0;
+    if (v == exact)
+        return 0;
+    if (std::isinf(exact) || exact == 0)
+        return INFINITY;
+    int e = ilogbl(exact);
+    if (e < -1022)
+        e = -1022;
+    return static_cast<double>(fabsl(v - exact) / ldexpl(1, e - 52));
+}
+
+struct Result {
+    double	sqrt;
+    double	exp;
+    double	log;
+    double	pow;
+};
+
+Result sweep(const VecMath &math, size_t count) {
+    Result worst = { 0, 0, 0, 0 };
+    std::vector<double> a(CHUNK), b(CHUNK), d(CHUNK);
+    for (size_t done = 0; done < count; done += CHUNK) {
+        /* positive normal numbers of any exponent */
+        for (unsigned int i = 0; i < CHUNK; ++i)
+            a[i] = std::ldexp(1 + uniform(), static_cast<int>(uniform() * 2044) - 1022);
+        math.sqrt(&d[0], &a[0], CHUNK);
+        for (unsigned int i = 0; i < CHUNK; ++i)
+            worst.sqrt = std::max(worst.sqrt, ulps(d[i], sqrtl(a[i])));
+        math.log(&d[0], &a[0], CHUNK);
+        for (unsigned int i = 0; i < CHUNK; ++i)
+            worst.log = std::max(worst.log, ulps(d[i], logl(a[i])));
+
+        /* results from about 2^-1010 to 2^1010 */
+        for (unsigned int i = 0; i < CHUNK; ++i)
+            a[i] = (uniform() * 2 - 1) * 700;
+        math.exp(&d[0], &a[0], CHUNK);
+        for (unsigned int i = 0; i < CHUNK; ++i)
+            worst.exp = std::max(worst.exp, ulps(d[i], expl(a[i])));
+
+        /* |y log(x)| up to 700 */
+        for (unsigned int i = 0; i < CHUNK; ++i) {
+            a[i] = std::ldexp(1 + uniform(), static_cast<int>(uniform() * 80) - 40);
+            double l = std::fabs(std::log(a[i]));
+            b[i] = (uniform() * 2 - 1) * (l > 1 ? 700 / l : 700);
+        }
+        math.pow(&d[0], &a[0], &b[0], CHUNK);
+        for (unsigned int i = 0; i < CHUNK; ++i)
+            worst.pow = std::max(worst.pow, ulps(d[i], powl(a[i], b[i])));
+    }
+    return worst;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    /* arguments per function and level */
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 4 << 20;
+    bool ok = true;
+    for (int level = VECMATH_AVX2; level <= VecMath::supported(); ++level) {
+        const VecMath &math = VecMath::get(static_cast<VecMathLevel>(level));
+        Result worst = sweep(math, count);
+        std::cout << "ulptest: " << math.name << " sqrt " << worst.sqrt << ", exp " << worst.exp << ", log " << worst.log << ", pow " << worst.pow << " ULP" << std::endl;
+        /* the long double reference is itself off by about 2^-11 ULP */
+        if (worst.sqrt > 0.5005 || worst.exp > 0.52 || worst.log > 0.52 || worst.pow > 0.52)
+            ok = false;
+    }
+    if (!ok)
+        std::cerr << "ulptest: above the bounds of vecmath.h" << std::endl;
+    return ok ? 0 : 1;
+}
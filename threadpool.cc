@@ -0,0 +1,121 @@
+/**
+ * @file threadpool.cc
+ * @brief work-stealing thread pool for ranges of rows
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include "threadpool.h"
+
+YxlangThreadPool::YxlangThreadPool(unsigned int nthreads) : nworkers(nthreads ? nthreads : 1), ranges(nworkers),
+    generation(0), busy(0), stopping(false), task(NULL), total(0), morselsize(1) {
+    for (unsigned int i = 0; i < nworkers; ++i)
+        ranges[i].bits.store(0);
+    for (unsigned int i = 1; i < nworkers; ++i)
+        threads.push_back(std::thread(&YxlangThreadPool::loop, this, i));
+}
+
+YxlangThreadPool::~YxlangThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (unsigned int i = 0; i < threads.size(); ++i)
+        threads[i].join();
+}
+
+void YxlangThreadPool::run(size_t n, size_t morsel, const Task &_task) {
+    if (!n)
+        return;
+    if (!morsel)
+        morsel = 1;
+
+    /* equal shares of the morsels, the first workers get one more */
+    size_t nmorsels = (n + morsel - 1) / morsel;
+    uint32_t lo = 0;
+    for (unsigned int i = 0; i < nworkers; ++i) {
+        uint32_t count = nmorsels / nworkers + (i < nmorsels % nworkers ? 1 : 0);
+        ranges[i].bits.store(pack(lo, lo + count));
+        lo += count;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &_task;
+        total = n;
+        morselsize = morsel;
+        busy = nworkers;
+        ++generation;
+    }
+    wake.notify_all();
+
+    work(0);
+    std::unique_lock<std::mutex> lock(mutex);
+    --busy;
+    while (busy)
+        done.wait(lock);
+    task = NULL;
+}
+
+void YxlangThreadPool::loop(unsigned int id) {
+    unsigned long seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopping && generation == seen)
+                wake.wait(lock);
+            if (stopping)
+                return;
+            seen = generation;
+        }
+        work(id);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy == 0)
+            done.notify_all();
+    }
+}
+
+void YxlangThreadPool::work(unsigned int id) {
+    uint32_t m;
+    while (take(id, m) || steal(id, m)) {
+        size_t begin = m * morselsize;
+        size_t end = begin + morselsize < total ? begin + morselsize : total;
+        (*task)(begin, end);
+    }
+}
+
+bool YxlangThreadPool::take(unsigned int id, uint32_t &m) {
+    uint64_t bits = ranges[id].bits.load();
+    for (;;) {
+        uint32_t lo = static_cast<uint32_t>(bits);
+        uint32_t hi = static_cast<uint32_t>(bits >> 32);
+        if (lo >= hi)
+            return false;
+        if (ranges[id].bits.compare_exchange_weak(bits, pack(lo + 1, hi))) {
+            m = lo;
+            return true;
+        }
+    }
+}
+
+bool YxlangThreadPool::steal(unsigned int id, uint32_t &m) {
+    for (unsigned int k = 1; k < nworkers; ++k) {
+        Range &victim = ranges[(id + k) % nworkers];
+        uint64_t bits = victim.bits.load();
+        for (;;) {
+            uint32_t lo = static_cast<uint32_t>(bits);
+            uint32_t hi = static_cast<uint32_t>(bits >> 32);
+            if (lo >= hi)
+                break;
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (victim.bits.compare_exchange_weak(bits, pack(lo, mid))) {
+                /* run the first stolen morsel, the rest becomes our own
+                 * range. It is empty, so no thief is changing it. */
+                ranges[id].bits.store(pack(mid + 1, hi));
+                m = mid;
+                return true;
+            }
+        }
+    }
+    return false;
+}
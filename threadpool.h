@@ -0,0 +1,81 @@
+/**
+ * @file threadpool.h
+ * @brief work-stealing thread pool for ranges of rows
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <stdint.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+/** A fixed set of threads that run one range job at a time. The range is
+ * cut into morsels, each thread starts with an equal share of them and
+ * takes its own morsels from the front. A thread that runs out steals the
+ * back half of another thread's remaining morsels. Taking and stealing is
+ * one compare-and-swap on the owner's range, the only lock guards starting
+ * and finishing a job. The calling thread works as well. */
+class YxlangThreadPool {
+public:
+    /// task(begin, end) handles the items [begin, end)
+    typedef std::function<void (size_t, size_t)>	Task;
+
+    /** nthreads threads in all, the caller of run() included */
+    explicit YxlangThreadPool(unsigned int nthreads);
+    ~YxlangThreadPool();
+
+    unsigned int size() const {
+        return nworkers;
+    }
+
+    /** run task over [0, n) in morsels of size morsel, returns when all of
+     * them are done. Not reentrant, one job at a time. */
+    void	run(size_t n, size_t morsel, const Task &task);
+
+private:
+    YxlangThreadPool(const YxlangThreadPool &);
+    YxlangThreadPool& operator=(const YxlangThreadPool &);
+
+    /** morsels [lo, hi) of one worker, packed so both ends change at once */
+    struct Range {
+        std::atomic<uint64_t>	bits;
+        /// keep the ranges of different workers on different cache lines
+        char	pad[64 - sizeof(std::atomic<uint64_t>)];
+    };
+
+    static uint64_t pack(uint32_t lo, uint32_t hi) {
+        return static_cast<uint64_t>(hi) << 32 | lo;
+    }
+
+    void	loop(unsigned int id);
+    void	work(unsigned int id);
+    bool	take(unsigned int id, uint32_t &m);
+    bool	steal(unsigned int id, uint32_t &m);
+
+    unsigned int	nworkers;
+    std::vector<std::thread>	threads;
+    std::vector<Range>	ranges;
+
+    std::mutex	mutex;
+    std::condition_variable	wake;
+    std::condition_variable	done;
+    /// bumped for every job, tells the threads there is work
+    unsigned long	generation;
+    /// threads still working on the current job
+    unsigned int	busy;
+    bool	stopping;
+
+    /// the current job
+    const Task*	task;
+    size_t	total;
+    size_t	morselsize;
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,84 @@
+/**
+ * @file vecmath.cc
+ * @brief scalar kernels and CPUID dispatch of the column kernels
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <cmath>
+#include "vecmath_impl.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace {
+
+void scalarSqrt(double* d, const double* a, unsigned int n) {
+    for (unsigned int i = 0; i < n; ++i)
+        d[i] = std::sqrt(a[i]);
+}
+
+void scalarExp(double* d, const double* a, unsigned int n) {
+    for (unsigned int i = 0; i < n; ++i)
+        d[i] = std::exp(a[i]);
+}
+
+void scalarLog(double* d, const double* a, unsigned int n) {
+    for (unsigned int i = 0; i < n; ++i)
+        d[i] = std::log(a[i]);
+}
+
+void scalarPow(double* d, const double* a, const double* b, unsigned int n) {
+    for (unsigned int i = 0; i < n; ++i)
+        d[i] = std::pow(a[i], b[i]);
+}
+
+const VecMath scalar = { VECMATH_SCALAR, "scalar", &scalarSqrt, &scalarExp, &scalarLog, &scalarPow };
+
+const VecMath* kernels(VecMathLevel level) {
+    static const VecMathLevel best = VecMath::supported();
+    if (level > best)
+        level = best;
+    switch (level) {
+        case VECMATH_AVX512:
+            return &vecmath::avx512;
+        case VECMATH_AVX2:
+            return &vecmath::avx2;
+        default:
+            return &scalar;
+    }
+}
+
+} // namespace
+
+VecMathLevel VecMath::supported() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return VECMATH_SCALAR;
+    if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX) || !(ecx & bit_FMA))
+        return VECMATH_SCALAR;
+    /* the OS has to save the ymm registers, and the zmm ones for AVX-512 */
+    unsigned int xcr0, xcr0high;
+    __asm__ ("xgetbv" : "=a" (xcr0), "=d" (xcr0high) : "c" (0));
+    if ((xcr0 & 0x6) != 0x6)
+        return VECMATH_SCALAR;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) || !(ebx & bit_AVX2))
+        return VECMATH_SCALAR;
+    if ((ebx & bit_AVX512F) && (xcr0 & 0xe6) == 0xe6)
+        return VECMATH_AVX512;
+    return VECMATH_AVX2;
+#else
+    return VECMATH_SCALAR;
+#endif
+}
+
+const VecMath& VecMath::current() {
+    /* thread safe, the first call picks the best level */
+    static const VecMath* const best = kernels(supported());
+    return *best;
+}
+
+const VecMath& VecMath::get(VecMathLevel level) {
+    return *kernels(level);
+}
@@ -0,0 +1,59 @@
+/**
+ * @file vecmath.h
+ * @brief sqrt, exp, log and pow over columns of doubles
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#ifndef VECMATH_H
+#define VECMATH_H
+
+/** d[i] = f(a[i]) for i < n, d may be a */
+typedef void (*VecUnaryKernel)(double* d, const double* a, unsigned int n);
+/** d[i] = f(a[i], b[i]) for i < n, d may be a or b */
+typedef void (*VecBinaryKernel)(double* d, const double* a, const double* b, unsigned int n);
+
+/** instruction sets with kernels, in increasing order */
+enum VecMathLevel {
+    VECMATH_SCALAR,
+    VECMATH_AVX2,
+    VECMATH_AVX512
+};
+
+/** One set of column kernels. The scalar level calls libm per element.
+ * The AVX2 (with FMA) and AVX-512F levels evaluate 4 or 8 elements at a
+ * time and are only selected when CPUID and XGETBV report that the CPU and
+ * the OS support them.
+ *
+ * Error bounds of the SIMD kernels, in units in the last place of the
+ * exact result:
+ * - sqrt is correctly rounded, the same as std::sqrt.
+ * - exp and log are below 0.52 ULP. exp(x) reduces x to k ln2/128 + r
+ *   with ln2/128 split in two, looks 2^(k/128) up in a table and uses a
+ *   degree 5 polynomial for exp(r). log(x) splits x = 2^k z, looks
+ *   1/c and log(c) up for the c closest to z and uses a degree 10
+ *   polynomial for log1p(z/c - 1), summed in double-double.
+ * - pow(x, y) is below 0.52 ULP. It is exp(y log(x)) with log(x) and the
+ *   product kept in double-double, so |y log(x)| up to 708 loses nothing.
+ * Lanes outside the range of the fast path, that is zero, negative,
+ * subnormal, infinite or NaN arguments and results that would overflow or
+ * be subnormal, are recomputed with libm, so special values behave as in
+ * std::exp, std::log and std::pow. */
+struct VecMath {
+    VecMathLevel	level;
+    const char*	name;
+    VecUnaryKernel	sqrt;
+    VecUnaryKernel	exp;
+    VecUnaryKernel	log;
+    VecBinaryKernel	pow;
+
+    /** the kernels of the best level supported */
+    static const VecMath&	current();
+    /** the kernels of level, or those of the best supported level below
+     * it. A context uses them after YxlangContext::setVecMath(). */
+    static const VecMath&	get(VecMathLevel level);
+    /** best level the CPU and the OS support */
+    static VecMathLevel	supported();
+};
+
+#endif // VECMATH_H
@@ -0,0 +1,46 @@
+/**
+ * @file vecmath_avx2.cc
+ * @brief AVX2 and FMA column kernels, built with -mavx2 -mfma
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <immintrin.h>
+#include "vecmath_impl.h"
+
+namespace {
+
+struct Avx2 {
+    typedef __m256d	vd;
+    typedef __m256i	vi;
+    enum { N = 4 };
+
+    static vd load(const double* p) {
+        return _mm256_loadu_pd(p);
+    }
+    static void store(double* p, vd x) {
+        _mm256_storeu_pd(p, x);
+    }
+    static vd set1(double x) {
+        return _mm256_set1_pd(x);
+    }
+    static vd fma(vd a, vd b, vd c) {
+        return _mm256_fmadd_pd(a, b, c);
+    }
+    static vd sqrt(vd x) {
+        return _mm256_sqrt_pd(x);
+    }
+    static vd gather(const double* base, vi index) {
+        return _mm256_i64gather_pd(base, index, 8);
+    }
+    static vi gatheri(const long long* base, vi index) {
+        return _mm256_i64gather_epi64(base, index, 8);
+    }
+    static int mask(vi m) {
+        return _mm256_movemask_pd((vd)m);
+    }
+};
+
+} // namespace
+
+const VecMath vecmath::avx2 = vecmath::Kernels<Avx2>::make(VECMATH_AVX2, "avx2");
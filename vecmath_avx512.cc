@@ -0,0 +1,48 @@
+/**
+ * @file vecmath_avx512.cc
+ * @brief AVX-512F column kernels, built with -mavx512f
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include <immintrin.h>
+#include "vecmath_impl.h"
+
+namespace {
+
+struct Avx512 {
+    typedef __m512d	vd;
+    typedef __m512i	vi;
+    enum { N = 8 };
+
+    static vd load(const double* p) {
+        return _mm512_loadu_pd(p);
+    }
+    static void store(double* p, vd x) {
+        _mm512_storeu_pd(p, x);
+    }
+    static vd set1(double x) {
+        return _mm512_set1_pd(x);
+    }
+    static vd fma(vd a, vd b, vd c) {
+        return _mm512_fmadd_pd(a, b, c);
+    }
+    /* the masked forms, the plain ones trip -Wmaybe-uninitialized in the
+     * GCC 12 headers at -O2 */
+    static vd sqrt(vd x) {
+        return _mm512_maskz_sqrt_pd(0xff, x);
+    }
+    static vd gather(const double* base, vi index) {
+        return _mm512_mask_i64gather_pd(_mm512_setzero_pd(), 0xff, index, base, 8);
+    }
+    static vi gatheri(const long long* base, vi index) {
+        return _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), 0xff, index, base, 8);
+    }
+    static int mask(vi m) {
+        return _mm512_test_epi64_mask(m, m);
+    }
+};
+
+} // namespace
+
+const VecMath vecmath::avx512 = vecmath::Kernels<Avx512>::make(VECMATH_AVX512, "avx512");
@@ -0,0 +1,186 @@
+/**
+ * @file vecmath_data.cc
+ * @brief lookup tables of the SIMD exp, log and pow kernels
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#include "vecmath_impl.h"
+
+/* computed with 60 significant digits and rounded to double, following
+ * the definitions in vecmath_impl.h */
+
+const long long vecmath::expbits[EXP_N] = {
+    0x3ff0000000000000LL, 0x3feff63da9fb3335LL, 0x3fefec9a3e778061LL, 0x3fefe315e86e7f85LL,
+    0x3fefd9b0d3158574LL, 0x3fefd06b29ddf6deLL, 0x3fefc74518759bc8LL, 0x3fefbe3ecac6f383LL,
+    0x3fefb5586cf9890fLL, 0x3fefac922b7247f7LL, 0x3fefa3ec32d3d1a2LL, 0x3fef9b66affed31bLL,
+    0x3fef9301d0125b51LL, 0x3fef8abdc06c31ccLL, 0x3fef829aaea92de0LL, 0x3fef7a98c8a58e51LL,
+    0x3fef72b83c7d517bLL, 0x3fef6af9388c8deaLL, 0x3fef635beb6fcb75LL, 0x3fef5be084045cd4LL,
+    0x3fef54873168b9aaLL, 0x3fef4d5022fcd91dLL, 0x3fef463b88628cd6LL, 0x3fef3f49917ddc96LL,
+    0x3fef387a6e756238LL, 0x3fef31ce4fb2a63fLL, 0x3fef2b4565e27cddLL, 0x3fef24dfe1f56381LL,
+    0x3fef1e9df51fdee1LL, 0x3fef187fd0dad990LL, 0x3fef1285a6e4030bLL, 0x3fef0cafa93e2f56LL,
+    0x3fef06fe0a31b715LL, 0x3fef0170fc4cd831LL, 0x3feefc08b26416ffLL, 0x3feef6c55f929ff1LL,
+    0x3feef1a7373aa9cbLL, 0x3feeecae6d05d866LL, 0x3feee7db34e59ff7LL, 0x3feee32dc313a8e5LL,
+    0x3feedea64c123422LL, 0x3feeda4504ac801cLL, 0x3feed60a21f72e2aLL, 0x3feed1f5d950a897LL,
+    0x3feece086061892dLL, 0x3feeca41ed1d0057LL, 0x3feec6a2b5c13cd0LL, 0x3feec32af0d7d3deLL,
+    0x3feebfdad5362a27LL, 0x3feebcb299fddd0dLL, 0x3feeb9b2769d2ca7LL, 0x3feeb6daa2cf6642LL,
+    0x3feeb42b569d4f82LL, 0x3feeb1a4ca5d920fLL, 0x3feeaf4736b527daLL, 0x3feead12d497c7fdLL,
+    0x3feeab07dd485429LL, 0x3feea9268a5946b7LL, 0x3feea76f15ad2148LL, 0x3feea5e1b976dc09LL,
+    0x3feea47eb03a5585LL, 0x3feea34634ccc320LL, 0x3feea23882552225LL, 0x3feea155d44ca973LL,
+    0x3feea09e667f3bcdLL, 0x3feea012750bdabfLL, 0x3fee9fb23c651a2fLL, 0x3fee9f7df9519484LL,
+    0x3fee9f75e8ec5f74LL, 0x3fee9f9a48a58174LL, 0x3fee9feb564267c9LL, 0x3feea0694fde5d3fLL,
+    0x3feea11473eb0187LL, 0x3feea1ed0130c132LL, 0x3feea2f336cf4e62LL, 0x3feea427543e1a12LL,
+    0x3feea589994cce13LL, 0x3feea71a4623c7adLL, 0x3feea8d99b4492edLL, 0x3feeaac7d98a6699LL,
+    0x3feeace5422aa0dbLL, 0x3feeaf3216b5448cLL, 0x3feeb1ae99157736LL, 0x3feeb45b0b91ffc6LL,
+    0x3feeb737b0cdc5e5LL, 0x3feeba44cbc8520fLL, 0x3feebd829fde4e50LL, 0x3feec0f170ca07baLL,
+    0x3feec49182a3f090LL, 0x3feec86319e32323LL, 0x3feecc667b5de565LL, 0x3feed09bec4a2d33LL,
+    0x3feed503b23e255dLL, 0x3feed99e1330b358LL, 0x3feede6b5579fdbfLL, 0x3feee36bbfd3f37aLL,
+    0x3feee89f995ad3adLL, 0x3feeee07298db666LL, 0x3feef3a2b84f15fbLL, 0x3feef9728de5593aLL,
+    0x3feeff76f2fb5e47LL, 0x3fef05b030a1064aLL, 0x3fef0c1e904bc1d2LL, 0x3fef12c25bd71e09LL,
+    0x3fef199bdd85529cLL, 0x3fef20ab5fffd07aLL, 0x3fef27f12e57d14bLL, 0x3fef2f6d9406e7b5LL,
+    0x3fef3720dcef9069LL, 0x3fef3f0b555dc3faLL, 0x3fef472d4a07897cLL, 0x3fef4f87080d89f2LL,
+    0x3fef5818dcfba487LL, 0x3fef60e316c98398LL, 0x3fef69e603db3285LL, 0x3fef7321f301b460LL,
+    0x3fef7c97337b9b5fLL, 0x3fef864614f5a129LL, 0x3fef902ee78b3ff6LL, 0x3fef9a51fbc74c83LL,
+    0x3fefa4afa2a490daLL, 0x3fefaf482d8e67f1LL, 0x3fefba1bee615a27LL, 0x3fefc52b376bba97LL,
+    0x3fefd0765b6e4540LL, 0x3fefdbfdad9cbe14LL, 0x3fefe7c1819e90d8LL, 0x3feff3c22b8f71f1LL
+};
+
+const double vecmath::exptail[EXP_N] = {
+    0.0, 9.447885451727066e-17, -1.507066976926039e-17, -5.679155082825012e-17,
+    4.9997448722726326e-17, -4.823683599994895e-17, 7.357846871247418e-18, 5.773230223741951e-17,
+    8.189317638195515e-17, 5.326891139980878e-17, 1.6665881442326747e-18, -1.128113245461828e-17,
+    -7.402825309426177e-17, -3.578659767309563e-18, -6.170654745608695e-17, 2.919139999949279e-17,
+    -2.7939114859515733e-17, -5.399285355184285e-17, 4.776959425256223e-17, -7.927701432338473e-17,
+    9.341710609905046e-17, -5.534520675707472e-17, 4.585670326662351e-17, 2.8582430411116143e-17,
+    7.826573258636076e-17, 4.053626906769216e-17, 2.823784425951061e-17, -7.882802262487991e-17,
+    3.2904726646008416e-17, -1.5792094703347882e-18, 4.721368121170128e-17, 1.3045277096919659e-17,
+    3.3484623336251524e-17, 3.8611199774925664e-17, 5.527550048505249e-17, -3.927184172445234e-17,
+    -6.346552106729483e-17, -8.684417614865944e-17, -1.5456342819397733e-17, -8.70763476495455e-17,
+    3.750854201303127e-17, -6.616854503526488e-17, -5.346099009198751e-18, -2.443726321015018e-17,
+    2.1023049675215714e-18, 7.771067937501065e-17, 1.3357510088834541e-17, 6.938291696959204e-17,
+    1.9572585293112036e-17, 6.632256961675804e-17, -5.478069123926778e-17, -4.140839310392624e-17,
+    -2.1571477251208752e-17, -3.8287766552120535e-17, 6.663804589232195e-17, 2.3936187400285282e-17,
+    5.68648095791174e-17, 1.1264523354521684e-18, 7.007875046906994e-17, -5.0119214278381254e-17,
+    -4.8923067513522756e-17, -3.5260089953269434e-17, -6.872303720902018e-17, 5.001446664133532e-18,
+    -6.835808657661922e-17, -1.1307344092910212e-17, -8.416011634717156e-18, -2.9247977035436566e-17,
+    -2.092304381843353e-17, -3.9778645875427124e-17, -3.833464968654295e-17, 5.763611164480894e-17,
+    -2.3591094770850053e-17, 7.260074661098575e-17, 9.50689710108796e-18, -4.272956133839906e-17,
+    -6.735219232374683e-17, -2.8396044410430936e-17, -7.226635472101257e-17, 5.786121003395918e-17,
+    5.1548301170786783e-17, -9.416257568878152e-18, 2.4253985766689806e-17, -6.604314051707707e-17,
+    -6.432131775424189e-18, -1.2204007601863921e-17, -6.336161863401293e-17, -3.7800879246373815e-17,
+    1.5341410053603723e-17, 1.2932855580427452e-17, -4.123367330661149e-17, 4.703083974463456e-17,
+    -6.152602891550265e-17, 5.827849326195279e-17, 3.540948262646183e-17, -3.2741571320938764e-17,
+    4.875160526227062e-17, -5.718569790077838e-17, -4.719539664590972e-18, -5.773451958805706e-17,
+    -1.0772487078934056e-17, -6.221808618533911e-17, 1.821405440362259e-17, -6.155536546227639e-17,
+    1.685487290628973e-17, 5.3581249177694816e-17, 3.621615935336894e-17, 8.588379527574144e-18,
+    1.01562190116415e-17, -2.869134889187244e-17, -5.495118966122005e-17, -5.56965572431627e-17,
+    1.790126907604513e-17, -3.2211766346200164e-17, 5.265370768556274e-17, 3.5089866402403033e-17,
+    -3.266924100901318e-17, -4.3657593008079375e-17, 1.7963932659833022e-17, 3.4300925275214166e-17,
+    -5.545065618639427e-17, -5.149009745457733e-17, 5.336805878514151e-17, 3.498978661192973e-17,
+    4.5784915277060095e-17, -5.241934575393899e-17, 2.0414278897578303e-17, 4.124842848606488e-18
+};
+
+const double vecmath::invc[LOG_N] = {
+    1.4140625, 1.40625, 1.3984375, 1.390625,
+    1.3828125, 1.375, 1.3671875, 1.359375,
+    1.3515625, 1.34375, 1.3359375, 1.3359375,
+    1.328125, 1.3203125, 1.3125, 1.3046875,
+    1.296875, 1.2890625, 1.2890625, 1.28125,
+    1.2734375, 1.265625, 1.2578125, 1.25,
+    1.25, 1.2421875, 1.234375, 1.2265625,
+    1.2265625, 1.21875, 1.2109375, 1.203125,
+    1.203125, 1.1953125, 1.1875, 1.1875,
+    1.1796875, 1.171875, 1.171875, 1.1640625,
+    1.15625, 1.1484375, 1.1484375, 1.140625,
+    1.140625, 1.1328125, 1.125, 1.125,
+    1.1171875, 1.109375, 1.109375, 1.1015625,
+    1.1015625, 1.09375, 1.0859375, 1.0859375,
+    1.078125, 1.078125, 1.0703125, 1.0625,
+    1.0625, 1.0546875, 1.0546875, 1.046875,
+    1.046875, 1.0390625, 1.0390625, 1.03125,
+    1.03125, 1.0234375, 1.015625, 1.015625,
+    1.0078125, 1.0078125, 1.0, 1.0,
+    0.9921875, 0.984375, 0.9765625, 0.96875,
+    0.9609375, 0.953125, 0.9453125, 0.94140625,
+    0.93359375, 0.92578125, 0.91796875, 0.9140625,
+    0.90625, 0.8984375, 0.89453125, 0.88671875,
+    0.8828125, 0.875, 0.87109375, 0.86328125,
+    0.859375, 0.8515625, 0.84765625, 0.83984375,
+    0.8359375, 0.83203125, 0.82421875, 0.8203125,
+    0.8125, 0.80859375, 0.8046875, 0.80078125,
+    0.79296875, 0.7890625, 0.78515625, 0.78125,
+    0.7734375, 0.76953125, 0.765625, 0.76171875,
+    0.7578125, 0.75390625, 0.74609375, 0.7421875,
+    0.73828125, 0.734375, 0.73046875, 0.7265625,
+    0.72265625, 0.71875, 0.71484375, 0.7109375
+};
+
+const double vecmath::logc[LOG_N] = {
+    -0.34646676734620857, -0.3409265869705932, -0.3353555419211378, -0.329753286372468,
+    -0.324119468654212, -0.3184537311185346, -0.3127557100038969, -0.3070250352949119,
+    -0.3012613305781618, -0.2954642128938359, -0.28963329258304266, -0.28963329258304266,
+    -0.2837681731306446, -0.2778684510034563, -0.27193371548364176, -0.26596354849713794,
+    -0.25995752443692605, -0.25391520998096345, -0.25391520998096345, -0.24783616390458127,
+    -0.24171993688714516, -0.2355660713127669, -0.22937410106484582, -0.22314355131420976,
+    -0.22314355131420976, -0.21687393830061436, -0.21056476910734964, -0.2042155414286909,
+    -0.2042155414286909, -0.19782574332991987, -0.19139485299962947, -0.184922338494012,
+    -0.184922338494012, -0.1784076574728183, -0.17185025692665923, -0.17185025692665923,
+    -0.16524957289530717, -0.15860503017663857, -0.15860503017663857, -0.15191604202584197,
+    -0.1451820098444979, -0.13840232285911913, -0.13840232285911913, -0.13157635778871926,
+    -0.13157635778871926, -0.12470347850095724, -0.11778303565638346, -0.11778303565638346,
+    -0.11081436634029011, -0.10379679368164356, -0.10379679368164356, -0.09672962645855111,
+    -0.09672962645855111, -0.08961215868968714, -0.08244366921107459, -0.08244366921107459,
+    -0.07522342123758753, -0.07522342123758753, -0.06795066190850775, -0.06062462181643484,
+    -0.06062462181643484, -0.053244514518812285, -0.053244514518812285, -0.0458095360312942,
+    -0.0458095360312942, -0.0383188643021366, -0.0383188643021366, -0.030771658666753687,
+    -0.030771658666753687, -0.02316705928153438, -0.015504186535965254, -0.015504186535965254,
+    -0.007782140442054949, -0.007782140442054949, 0.0, 0.0,
+    0.007843177461025893, 0.015748356968139168, 0.023716526617316044, 0.0317486983145803,
+    0.039845908547199674, 0.048009219186360606, 0.05623971832287608, 0.06038051098890748,
+    0.06871389254805181, 0.07711730334443129, 0.08559193033540351, 0.08985632912186105,
+    0.09844007281325252, 0.1070981355563671, 0.11145544092532282, 0.1202274269981598,
+    0.1246424452072766, 0.13353139262452263, 0.13800567301944372, 0.14701474296180966,
+    0.15154989812720093, 0.16068238169047347, 0.16528009093910292, 0.17453941635189968,
+    0.179201429457711, 0.18388527877013736, 0.19331931100349597, 0.1980699137620938,
+    0.2076393647782445, 0.2124586512141934, 0.2173012756899814, 0.2221674653411543,
+    0.23197146543777514, 0.2369097470783577, 0.24187253642048673, 0.24686007793152578,
+    0.2569104137850272, 0.26197371574157396, 0.26706278524904525, 0.27217788591581565,
+    0.27731928541623435, 0.2824872555746769, 0.2929040164329326, 0.29815337231907635,
+    0.3034304294199201, 0.3087354816496133, 0.31406882762497584, 0.3194307707663612,
+    0.32482161940123766, 0.33024168687057687, 0.33569129163814154, 0.34117075740276714
+};
+
+const double vecmath::logctail[LOG_N] = {
+    -1.028583585496265e-17, -1.7467136443544747e-17, -1.834564437059473e-17, -2.122020616196946e-18,
+    7.958214381893813e-18, -2.7114779367326236e-17, 1.451808353098951e-17, 1.2319916200101964e-17,
+    9.048511144048564e-18, 2.16461086040599e-17, -2.0535953219858174e-17, -2.0535953219858174e-17,
+    2.032665581126656e-17, 9.16018294909263e-19, -7.83319637697442e-19, -5.3393802761314314e-18,
+    -2.069806938978935e-17, 8.048097394424201e-18, 8.048097394424201e-18, 1.2432209578702523e-17,
+    -8.900990022166643e-18, 2.3943371495187355e-18, -9.927671823978025e-18, 9.091270597324799e-18,
+    9.091270597324799e-18, -4.551026193234283e-18, 4.249405314729895e-18, -2.7338281018722773e-18,
+    -2.7338281018722773e-18, -1.2821194372980142e-17, 1.2129496905792884e-17, -3.0236614153574064e-18,
+    -3.0236614153574064e-18, 1.2432553788701131e-17, 6.0224538210113705e-18, 6.0224538210113705e-18,
+    1.0094935622322628e-17, -1.1257003872182592e-17, -1.1257003872182592e-17, -6.4838631244022194e-18,
+    -8.242418783022475e-18, -4.447777301357527e-18, -4.447777301357527e-18, -1.1123000879729588e-17,
+    -1.1123000879729588e-17, 4.6522609636496624e-18, 1.1971685747593677e-18, 1.1971685747593677e-18,
+    -1.183748342825649e-18, -5.47772415726659e-18, -5.47772415726659e-18, 5.597397486289965e-19,
+    5.597397486289965e-19, 5.4268129336647135e-18, -5.700437773813987e-18, -5.700437773813987e-18,
+    5.930604196293241e-18, 5.930604196293241e-18, 1.2802141240611733e-18, -2.6424025938726934e-18,
+    -2.6424025938726934e-18, 1.665575816973663e-18, 1.665575816973663e-18, -1.902959866474257e-18,
+    -1.902959866474257e-18, 2.357996157351286e-18, 2.357996157351286e-18, -1.0431732029005968e-18,
+    -1.0431732029005968e-18, 1.1769544932063305e-18, 3.278321022892429e-19, 3.278321022892429e-19,
+    1.2819179123343845e-20, 1.2819179123343845e-20, 0.0, 0.0,
+    2.764708154124904e-19, 1.0021578630528974e-18, -1.5774243488668215e-18, 3.0382263084680858e-18,
+    -3.129547680315208e-18, 1.4390903347292205e-18, -3.2835149805605613e-18, -2.1569637373409678e-18,
+    -2.5298812881248404e-18, 2.5654358635266204e-18, 6.769872319991152e-18, -6.273760163689594e-19,
+    -4.439009633675136e-18, -1.73705104015906e-18, 5.685957919022839e-18, -2.8375497328444e-18,
+    -5.808912678940971e-18, -3.664457663660085e-18, -3.082753002960249e-18, -4.46694718500102e-18,
+    5.1669593684615594e-18, -3.650183553047837e-18, -6.262313551919987e-19, -1.5833038914101321e-18,
+    -1.0785017454858423e-17, 6.716094199344591e-18, 4.630440315107144e-18, 3.742843482461439e-18,
+    1.2053243216686129e-17, -9.63115306272449e-18, 1.6168452453763015e-18, -1.0797202916767509e-17,
+    5.774320510479237e-18, 1.9682402978398164e-18, -3.5869293176775316e-18, 1.361743371748368e-17,
+    2.502843296152504e-17, 3.769957084925505e-18, -7.32891532732017e-18, 1.9460544362807653e-17,
+    -7.44528405583513e-18, 1.3652325538490778e-17, -2.097144388760612e-17, -1.720695867445866e-17,
+    -4.151258540103992e-18, -1.6199186085148102e-17, 7.311073985078525e-18, 1.354256857264811e-18,
+    -3.7162556628635935e-18, -1.0828321637483858e-17, -7.183773020381283e-18, -1.9366790062602867e-17
+};
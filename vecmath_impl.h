@@ -0,0 +1,209 @@
+/**
+ * @file vecmath_impl.h
+ * @brief tables and SIMD algorithms shared by the vecmath kernels
+ * @author yingxue
+ * @date 2026-10-16
+ */
+
+#ifndef VECMATH_IMPL_H
+#define VECMATH_IMPL_H
+
+#include <cmath>
+#include <cfloat>
+#include "vecmath.h"
+
+namespace vecmath {
+
+enum {
+    /// 2^(j/EXP_N) entries of the exp table
+    EXP_BITS = 7,
+    EXP_N = 1 << EXP_BITS,
+    /// subintervals of [OFF, 2 OFF) in the log table
+    LOG_BITS = 7,
+    LOG_N = 1 << LOG_BITS
+};
+
+/// bits of 2^(j/EXP_N) minus j << (52 - EXP_BITS), so that adding
+/// k << (52 - EXP_BITS) gives 2^(k/EXP_N) for any k with k mod EXP_N = j
+extern const long long expbits[EXP_N];
+/// 2^(j/EXP_N) = double(expbits) * (1 + exptail[j])
+extern const double exptail[EXP_N];
+/// 1/c for c in the middle of subinterval i, rounded to 8 bits so that
+/// z/c - 1 = fma(z, invc, -1) is exact. 1 for the subinterval holding 1.
+extern const double invc[LOG_N];
+/// -log(invc) = logc + logctail
+extern const double logc[LOG_N];
+extern const double logctail[LOG_N];
+
+/** kernels of the SIMD levels, defined in their own files because they are
+ * compiled for instruction sets the baseline may not have */
+extern const VecMath avx2;
+extern const VecMath avx512;
+
+/** exp: x = k ln2/EXP_N + r, ln2/EXP_N = Ln2hiN + Ln2loN with Ln2hiN
+ * short enough that k * Ln2hiN is exact */
+const double InvLn2N = 184.6649652337873;
+const double Ln2hiN = 0.0054152123482253955;
+const double Ln2loN = -1.0082281460997769e-13;
+/// largest |x| for which the result and 2^(k/EXP_N) stay normal and finite
+const double ExpLimit = 700;
+/// adding it rounds a double below 2^51 to an integer
+const double Shift = 6755399441055744.0;
+const long long ShiftBits = 0x4338000000000000LL;
+
+/** log: x = 2^k z with z in [OFF, 2 OFF), ln2 = Ln2hi + Ln2lo with Ln2hi
+ * short enough that k * Ln2hi is exact */
+const long long Off = 0x3fe6955500000000LL;
+const double Ln2hi = 0.6931471805598903;
+const double Ln2lo = 5.497923018708371e-14;
+
+/** The algorithms, generic over the vector type. V provides
+ * - vd, vi: vectors of N doubles and N long longs, GNU vector types
+ * - load, store, set1, fma, sqrt
+ * - gather(const double*, vi) and gatheri(const long long*, vi)
+ * - mask(vi): bit i set if lane i is all ones
+ * Everything else uses the GNU vector operators. */
+template <class V>
+struct Kernels {
+    typedef typename V::vd vd;
+    typedef typename V::vi vi;
+
+    static vd abs(vd x) {
+        return (vd)((vi)x & 0x7fffffffffffffffLL);
+    }
+
+    /** exp(x + xtail) for |x| <= ExpLimit and xtail much below ulp(x) */
+    static vd expcore(vd x, vd xtail) {
+        vd kd = x * InvLn2N + Shift;
+        vi ki = (vi)kd;
+        kd -= Shift;
+        vd r = x - kd * Ln2hiN - kd * Ln2loN + xtail;
+        vi j = ki & (EXP_N - 1);
+        vd tail = V::gather(exptail, j);
+        vd scale = (vd)(V::gatheri(expbits, j) + (ki << (52 - EXP_BITS)));
+        vd r2 = r * r;
+        /* |r| <= ln2/256, the r^6 term is below 2^-60 */
+        vd tmp = tail + r + r2 * (0.5 + r * (1.0 / 6)) + r2 * r2 * (1.0 / 24 + r * (1.0 / 120));
+        return scale + scale * tmp;
+    }
+
+    /** log(x) = result + tail for positive normal x */
+    static vd logcore(vd x, vd &tail) {
+        vi ix = (vi)x;
+        vi tmp = ix - Off;
+        vi i = (tmp >> (52 - LOG_BITS)) & (LOG_N - 1);
+        vi k = tmp >> 52;
+        vd z = (vd)(ix - (tmp & (long long)0xfff0000000000000ULL));
+        vd kd = (vd)(k + ShiftBits) - Shift;
+        vd ic = V::gather(invc, i);
+        vd lc = V::gather(logc, i);
+        vd lctail = V::gather(logctail, i);
+
+        /* |r| < 2^-7, exact */
+        vd r = V::fma(z, ic, V::set1(-1.0));
+        /* k ln2 + log(c) + r, with the rounding errors of both sums */
+        vd a = kd * Ln2hi;
+        vd t1 = a + lc;
+        vd bb = t1 - a;
+        vd e1 = (a - (t1 - bb)) + (lc - bb);
+        vd t2 = t1 + r;
+        bb = t2 - t1;
+        vd e2 = (t1 - (t2 - bb)) + (r - bb);
+        vd lo1 = kd * Ln2lo + lctail;
+        /* - r^2/2 with its rounding error */
+        vd ar = r * -0.5;
+        vd ar2 = r * ar;
+        vd lo3 = V::fma(ar, r, -ar2);
+        vd hi = t2 + ar2;
+        vd lo4 = t2 - hi + ar2;
+        /* r^3/3 - r^4/4 + ... - r^10/10, the next term is below 2^-70 r */
+        vd p = r * r * r * (1.0 / 3 + r * (-1.0 / 4 + r * (1.0 / 5 + r * (-1.0 / 6 + r * (1.0 / 7 + r * (-1.0 / 8 + r * (1.0 / 9 + r * (-1.0 / 10))))))));
+        vd lo = e1 + e2 + lo1 + lo3 + lo4 + p;
+        vd y = hi + lo;
+        tail = hi - y + lo;
+        return y;
+    }
+
+    static vd exp(vd x) {
+        vd y = expcore(x, V::set1(0));
+        int bad = V::mask(~(abs(x) <= ExpLimit));
+        for (int lane = 0; bad; ++lane, bad >>= 1) {
+            if (bad & 1)
+                y[lane] = std::exp(x[lane]);
+        }
+        return y;
+    }
+
+    static vd log(vd x) {
+        vd tail;
+        vd y = logcore(x, tail);
+        int bad = V::mask(~((x >= DBL_MIN) & (x <= DBL_MAX)));
+        for (int lane = 0; bad; ++lane, bad >>= 1) {
+            if (bad & 1)
+                y[lane] = std::log(x[lane]);
+        }
+        return y;
+    }
+
+    static vd pow(vd x, vd y) {
+        vd ltail;
+        vd l = logcore(x, ltail);
+        /* y log(x) = ehi + elo */
+        vd ehi = y * l;
+        vd elo = V::fma(y, l, -ehi) + y * ltail;
+        vd z = expcore(ehi, elo);
+        int bad = V::mask(~((x >= DBL_MIN) & (x <= DBL_MAX) & (abs(ehi) <= ExpLimit)));
+        for (int lane = 0; bad; ++lane, bad >>= 1) {
+            if (bad & 1)
+                z[lane] = std::pow(x[lane], y[lane]);
+        }
+        return z;
+    }
+
+    static vd sqrt(vd x) {
+        return V::sqrt(x);
+    }
+
+    /** run f over n elements, the rest of a vector is padded with ones */
+    template <vd (*f)(vd)>
+    static void unary(double* d, const double* a, unsigned int n) {
+        unsigned int i = 0;
+        for (; i + V::N <= n; i += V::N)
+            V::store(d + i, f(V::load(a + i)));
+        if (i < n) {
+            double buf[V::N];
+            for (unsigned int k = 0; k < V::N; ++k)
+                buf[k] = i + k < n ? a[i + k] : 1;
+            V::store(buf, f(V::load(buf)));
+            for (unsigned int k = 0; i + k < n; ++k)
+                d[i + k] = buf[k];
+        }
+    }
+
+    template <vd (*f)(vd, vd)>
+    static void binary(double* d, const double* a, const double* b, unsigned int n) {
+        unsigned int i = 0;
+        for (; i + V::N <= n; i += V::N)
+            V::store(d + i, f(V::load(a + i), V::load(b + i)));
+        if (i < n) {
+            double bufa[V::N];
+            double bufb[V::N];
+            for (unsigned int k = 0; k < V::N; ++k) {
+                bufa[k] = i + k < n ? a[i + k] : 1;
+                bufb[k] = i + k < n ? b[i + k] : 1;
+            }
+            V::store(bufa, f(V::load(bufa), V::load(bufb)));
+            for (unsigned int k = 0; i + k < n; ++k)
+                d[i + k] = bufa[k];
+        }
+    }
+
+    /** constexpr, so the kernel sets are initialized before any code runs */
+    static constexpr VecMath make(VecMathLevel level, const char* name) {
+        return VecMath{ level, name, &unary<sqrt>, &unary<exp>, &unary<log>, &binary<pow> };
+    }
+};
+
+} // namespace vecmath
+
+#endif // VECMATH_IMPL_H